@@ -178,6 +178,30 @@ uint8_t bin[] = {0xC0, 0x00, 0x63, 0xE1, 0x00, 0x01, 0x51, 0x00, 0x01}; //other
     uint8_t branch[] = {
 0xC1, 0x00, 0x18, 0xB0, 0x00, 0x00, 0x10, 0x00, 0x0F, 0x39, 0x00, 0x1A, 0x04, 0x00, 0x15, 0x39,
 0x00, 0x1C, 0x04, 0x00, 0x15, 0x50, 0x42, 0x40, 0x12, 0x34, 0x12, 0x35, 0x12, 0x00 //30
+};
+
+    uint8_t self_modify[] = {
+0xC8, 0x00, 0x02, 0x50, 0x00, 0x41, 0xC0, 0x00, 0x5A, 0xF1, 0x00, 0x05,
+0x88, 0x00, 0x01, 0x0C, 0x00, 0x03, 0x00 //19
+};
+
+    uint8_t alu_loop[] = {
+0xC0, 0x00, 0x00, 0xC8, 0x7F, 0xFF, 0x70, 0x00, 0x03, 0x90, 0x0F, 0xFF,
+0xA0, 0x00, 0x01, 0xB0, 0x00, 0x00, 0x88, 0x00, 0x01, 0x0C, 0x00, 0x06,
+0x00 //25
+};
+
+    uint8_t alu_direct[] = {
+0xC0, 0x00, 0x00, 0xC8, 0x7F, 0xFF, 0x71, 0x00, 0x1E, 0x81, 0x00, 0x20,
+0x91, 0x00, 0x22, 0xA1, 0x00, 0x20, 0x71, 0x00, 0x1E, 0x88, 0x00, 0x01,
+0x0C, 0x00, 0x06, 0x00, 0x00, 0x00, 0x12, 0x34, 0x00, 0x05, 0x0F, 0xFF
+//36
+};
+
+    uint8_t wrap[] = {
+0xC1, 0xFF, 0xFF, 0x39, 0xFF, 0xFF, 0xC0, 0x12, 0x34, 0xE1, 0xFF, 0xFF,
+0x39, 0xFF, 0xFF, 0x00
+//16
 };
 
     uint8_t invalid_file[] = {
@@ -187,6 +211,10 @@ uint8_t bin[] = {0xC0, 0x00, 0x63, 0xE1, 0x00, 0x01, 0x51, 0x00, 0x01}; //other
 0x49, 0x12
 };
       FILE *fp = fopen ("invalid2.pep8", "w");
+//	FILE *fp = fopen ("self_modify.pep8", "w");
+//	FILE *fp = fopen ("alu_loop.pep8", "w");
+//	FILE *fp = fopen ("alu_direct.pep8", "w");
+//	FILE *fp = fopen ("wrap.pep8", "w");
 //	FILE *fp = fopen ("fig_6_8.pep8", "w");
 //	FILE *fp = fopen ("fig_5_21.pep8","w");
 //	FILE *fp = fopen ("fig_5_21_modified.pep8","w");
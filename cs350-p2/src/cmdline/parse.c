@@ -15,8 +15,13 @@
 #include <unistd.h>             /* declares getopt() */
 #include <ctype.h>              /* declares isprint() */
 #include <stdbool.h>		/* bool type */
+#include <stdlib.h>		/* strtoul */
+#include <stdint.h>		/* uint16_t, used by interp.h */
 
 #include "parse.h"              /* prototypes for exported functions */
+#include "../interp/interp.h"	/* get_engine_by_id, trace levels */
+#include "../disasm/parallel.h"	/* MAX_DECODE_THREADS */
+#include "../output/print-records.h"	/* get_format_by_id */
 #include "../main/debug.h"      /* DEBUG statements */
 /* ************************************************************************* *
  * Local function prototypes                                                 *
@@ -67,26 +72,121 @@ void print_error()
  *     bool my_bool_value;                                                   *
  *     int return_code;                                                      *
  *     return_code = parse_command_line (..., &my_bool_value);               *
+ *                                                                           *
+ *   The options have since outgrown that, so they are all collected in a    *
+ *   single options_t (see parse.h) that the caller zero-initializes.        *
  * ************************************************************************* */
 
 int
-parse_command_line (int argc, char **argv,const char **filename,const char **svalue,
-		    _Bool* interpret)
+parse_command_line (int argc, char **argv,options_t* options)
 {
     int sflag = 0;
+    char* end = NULL;
     opterr = 0;
   
     int option;
-    while ((option = getopt (argc, argv, "s:i")) != -1)
+    while ((option = getopt (argc, argv,
+			     "s:ite:b:l:w:dc:o:g:j:rpf:C:x:k:")) != -1)
     {
         switch (option)
         {
 	case 's':
 	    sflag++;
-	    *svalue = optarg;
+	    options->symlist = optarg;
 	    break;
 	case 'i':
-	    *interpret = true;
+	    options->interpret = true;
+	    break;
+	case 't':
+	    options->stats = true;
+	    break;
+	case 'e':
+	    options->engine = get_engine_by_id(optarg);
+	    if (options->engine < 0)
+	    {
+		printf("Unknown engine \"%s\"\n",optarg);
+		return 1;
+	    }
+	    break;
+	case 'l':
+	    options->trace = get_trace_level_by_id(optarg);
+	    if (options->trace < 0)
+	    {
+		printf("Unknown trace level \"%s\"\n",optarg);
+		return 1;
+	    }
+	    options->interpret = true;
+	    options->headless = true;
+	    break;
+	case 'w':
+	    options->trace_file = optarg;
+	    options->trace = TRACE_BINARY;
+	    options->interpret = true;
+	    options->headless = true;
+	    break;
+	case 'd':
+	    options->decode = true;
+	    break;
+	case 'r':
+	    options->recursive = true;
+	    break;
+	case 'p':
+	    options->stream = true;
+	    break;
+	case 'f':
+	    options->format = get_format_by_id(optarg);
+	    if (options->format < 0)
+	    {
+		printf("Unknown format \"%s\"\n",optarg);
+		return 1;
+	    }
+	    break;
+	case 'C':
+	    options->cache_dir = optarg;
+	    break;
+	case 'x':
+	    options->xref = optarg;
+	    break;
+	case 'k':
+	    options->package_file = optarg;
+	    break;
+	case 'c':
+	    options->c_file = optarg;
+	    break;
+	case 'o':
+	    options->origin = strtoul(optarg,&end,0);
+	    if (*end != '\0' || options->origin > 0xFFFF)
+	    {
+		printf("-o needs an address from 0 to 0xFFFF\n");
+		return 1;
+	    }
+	    break;
+	case 'g':
+	    options->entry = strtoul(optarg,&end,0);
+	    if (*end != '\0' || options->entry > 0xFFFF)
+	    {
+		printf("-g needs an address from 0 to 0xFFFF\n");
+		return 1;
+	    }
+	    options->has_entry = true;
+	    break;
+	case 'j':
+	    options->decode_threads = strtoul(optarg,&end,10);
+	    if (*end != '\0' || options->decode_threads == 0 ||
+		options->decode_threads > MAX_DECODE_THREADS)
+	    {
+		printf("-j needs a number of threads from 1 to %d\n",
+		       MAX_DECODE_THREADS);
+		return 1;
+	    }
+	    break;
+	case 'b':
+	    options->bench_runs = strtoul(optarg,&end,10);
+	    if (*end != '\0' || options->bench_runs == 0)
+	    {
+		printf("-b needs a positive number of runs\n");
+		return 1;
+	    }
 	    break;
 	case '?':
             if (isprint (optopt))
@@ -106,18 +206,50 @@ parse_command_line (int argc, char **argv,const char **filename,const char **sva
 	}
     }
 
+    //-r makes up the symbol table that -s would read, and -p only lists
+    //what it has read so far, so it cannot have symbols or run the program.
+    //-f records are read by programs, so nothing else may share stdout.
+    //-C caches a disassembly, so it needs a run that makes one.
+    //-x prints references instead of the listing, and -k writes a package
+    if ((options->recursive && sflag) ||
+	(options->package_file != NULL &&
+	 (options->stream || options->interpret || options->decode ||
+	  options->c_file != NULL || options->bench_runs > 0 ||
+	  options->format != FORMAT_TEXT || options->cache_dir != NULL ||
+	  options->xref != NULL)) ||
+	(options->xref != NULL &&
+	 (options->stream || options->interpret || options->decode ||
+	  options->c_file != NULL || options->bench_runs > 0 ||
+	  options->format != FORMAT_TEXT)) ||
+	(options->cache_dir != NULL &&
+	 (options->stream || options->decode || options->headless ||
+	  options->bench_runs > 0)) ||
+	(options->format != FORMAT_TEXT &&
+	 (options->stream || options->interpret || options->decode ||
+	  options->c_file != NULL || options->bench_runs > 0)) ||
+	(options->stream && (sflag || options->recursive ||
+			     options->interpret || options->decode ||
+			     options->c_file != NULL ||
+			     options->bench_runs > 0 ||
+			     options->decode_threads > 1)))
+    {
+	print_error();
+	return 1;
+    }
+
     if (argc > optind)
     {
-        *filename = argv[optind];
+        options->filename = argv[optind];
         optind++;
-        if (*filename == NULL)
+        if (options->filename == NULL)
         {
             printf("Filename is invalid. Please try again.");
             return 1;
         }
         if (argc > optind)
         {
-            printf("Additional arguments after %s will be ignored.\n",*filename);
+            printf("Additional arguments after %s will be ignored.\n",
+		   options->filename);
         }
     }
     else
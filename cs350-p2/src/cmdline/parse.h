@@ -19,11 +19,42 @@
 /* ************************************************************************* *
  * Library includes here. If none needed, delete this comment.               *
  * ************************************************************************* */
+#include <stdbool.h>		/* bool type */
+
+/* ************************************************************************* *
+ * Options gathered from the command line.  Every new flag gets a field      *
+ * here instead of another call-by-reference parameter.                      *
+ * ************************************************************************* */
+typedef struct options {
+    const char* filename; //the object file to disassemble (required)
+    const char* symlist; //-s: symbol list file, NULL if not given
+    _Bool interpret; //-i: run the interpreter after the listing
+    _Bool stats; //-t: report timing statistics on stderr
+    int engine; //-e: execution engine, an engine_t (see interp.h)
+    int trace; //-l: trace level, a trace_t; TRACE_FULL unless -l is given
+    _Bool headless; //-l, -w: run without the disassembler listing
+    const char* trace_file; //-w: write a binary trace here, NULL if not given
+    _Bool decode; //-d: filename is a binary trace to print as text
+    unsigned bench_runs; //-b: benchmark the engines this many times, 0 = off
+    const char* c_file; //-c: translate the program to C here, NULL if not
+    unsigned origin; //-o: address the program is loaded at (a package's own)
+    unsigned entry; //-g: address the program starts at, the origin if not
+    _Bool has_entry; //-g was given: it overrides the origin and a package
+    unsigned decode_threads; //-j: disassemble on this many threads, 0 = one
+    _Bool recursive; //-r: follow the program to find code, data and labels
+    _Bool stream; //-p: list the file (or "-", stdin) while it is read; a
+		  //decode error comes after the lines before it, and a
+		  //missing STOP is not an error (see stream.c)
+    int format; //-f: listing format, a format_t (see print-records.h)
+    const char* cache_dir; //-C: keep disassemblies here, NULL if not given
+    const char* xref; //-x: list what refers to this label or address
+    const char* package_file; //-k: write a package here instead of listing
+} options_t;
 
 
 /* ************************************************************************* *
  * Function prototypes here. Note that variable names are often omitted.     *
  * ************************************************************************* */
-int parse_command_line (int, char **,const char**,const char**,_Bool*);
+int parse_command_line (int, char **,options_t*);
 
 #endif
@@ -1,64 +1,96 @@
 #ifndef __DISASM__
 #define __DISASM__
 
-#include "../main/pep8.h" /* mnemonic */
+#include "../main/pep8.h" /* mnemonic, instruction_t */
 
 typedef enum { LINE, ASCII, BLOCK, WORD } symtype_t;
 
 #define NUMBER_OF_SYMTYPES (WORD + 1)
 #define INVALID_SYMTYPE_ID -1
 
+/* A symbol: one fixed-size record in its symtab_t's array.  Offsets and
+ * lengths are 16 bits, as addresses are. */
+typedef struct symbol {
+    uint32_t label; //offset of the label in the table's strings, 0 if none
+    uint16_t offset; //the address it names, from the start of the image
+    uint16_t block_length; //0 unless a BLOCK
+    uint8_t type; //a symtype_t
+} symbol_t;
+
+/* The symbol table: the symbols in list order in one array, and their
+ * labels in one string pool.  The pool starts with an empty string, so no
+ * label is at offset 0 (see sym.c for adding to it). */
 typedef struct symtab {
-    char *label;
-    symtype_t type;
-    off_t offset;
-    size_t block_length;
-    struct symtab *next;
+    symbol_t* symbols;
+    uint32_t count;
+    uint32_t capacity;
+    char* strings;
+    uint32_t strings_length;
+    uint32_t strings_capacity;
+    uint32_t* slots; //while symbols are added: label offsets by hash
+    uint32_t slot_count; //a power of two, 0 once the table is indexed
+    uint32_t labels; //distinct labels in the pool
 } symtab_t;
 
-//define "Does not exist" variable for registr and addr_mode
-#define DNE 255
+/* The symbol table by address: at[a] is the first symbol in the list whose
+ * offset is a, or NULL.  symtab_index_build (sym.c) fills it once, so finding
+ * the symbol for an address never walks the list. */
+#define SYMTAB_INDEX_SIZE 0x10000
+
+typedef struct symtab_index {
+    const symtab_t* symtab; //the table the symbols are in
+    symbol_t* at[SYMTAB_INDEX_SIZE];
+} symtab_index_t;
+
+/* The symbol at addr, or NULL.  symbols may be NULL when there is no
+ * symbol table. */
+static inline symbol_t* symtab_lookup(const symtab_index_t* symbols,
+				      uint16_t addr)
+{
+    return symbols != NULL ? symbols->at[addr] : NULL;
+}
+
+/* The label of a symbol in symtab, or NULL if it has none */
+static inline const char* symbol_label(const symtab_t* symtab,
+				       const symbol_t* symbol)
+{
+    return symbol->label != 0 ? symtab->strings + symbol->label : NULL;
+}
+
+/* The disassembly: every instruction and directive in address order, in one
+ * array that determine_instructions grows as it goes.  inst_list_free
+ * releases all of it. */
+typedef struct inst_list {
+    instruction_t* items;
+    size_t count;
+    size_t capacity;
+} inst_list_t;
 
-typedef struct instruction_t {
-    uint16_t addr;
-    struct symtab* symb;
-    uint8_t inst_spec; //instruction specifier
-    uint8_t registr; //DNE if does not apply to this instruction
-    uint8_t addr_mode; //DNE if does not apply to this instruction
-    mnemonic_t mnem;
-    uint16_t op_spec; //if unary is true, op_spec arbitrarily set to DNE
-    _Bool unary; //unary means no op-spec
-    uint16_t ascii_bytes; //number of bytes in ascii string
-    _Bool single_digit_addressing;
-	//for branch and call instructions for "i,x"; preset to false
-    struct instruction_t *next;
-} instruction_t;
+/* Why decode_instruction could not decode an address */
+typedef enum decode_status {
+    DECODE_OK, //decoded
+    DECODE_NO_OPERAND, //an instruction that needs an operand runs off the end
+    DECODE_BAD_OP //not an instruction specifier
+} decode_status_t;
 
 /* Global constants defined in disasm-const.c */
 extern const char *MNEMONICS[];
 
 /*Prototypes*/
-void determine_instructions(instruction_t**,uint8_t*,int, symtab_t**);
+void determine_instructions(inst_list_t*,uint8_t*,int,const symtab_index_t*);
+decode_status_t decode_instruction(uint8_t*,int,const symtab_index_t*,int,
+				   instruction_t*,int*);
+void report_decode_error(decode_status_t,uint8_t);
+_Bool unary_specifier(uint8_t);
+void inst_list_init(inst_list_t*,size_t);
+instruction_t* inst_list_append(inst_list_t*);
+void inst_list_free(inst_list_t*);
 uint16_t determine_symbol_instruction(uint8_t*,uint8_t,uint16_t,
-                                      instruction_t*, symtab_t*);
-void determine_unary_instruction(uint8_t*,uint8_t,uint16_t,instruction_t*,
-				 symtab_t*);
-void determine_branch_call_instruction(uint8_t*,uint8_t,uint16_t,
-				       instruction_t*, symtab_t*);
-void determine_trap_instruction(uint8_t*,uint8_t,uint16_t,
-				instruction_t*, symtab_t*);
-void determine_stack_pointer_instruction(uint8_t*,uint8_t,uint16_t,
-					 instruction_t*, symtab_t*);
-void determine_add_sub_comp_instruction(uint8_t*,uint8_t,uint16_t,
-					instruction_t*, symtab_t*);
-void determine_load_store_instruction(uint8_t*,uint8_t,uint16_t,
-				      instruction_t*, symtab_t*);
-void determine_char_in_out_instruction(uint8_t*,uint8_t,uint16_t,
-				       instruction_t*, symtab_t*);
+                                      instruction_t*, symbol_t*);
 
 mnemonic_t get_mnemonic_by_id (const char*);
 instruction_t create_instruction(uint16_t, const char*, uint8_t,
 				 uint16_t, uint8_t, uint8_t,
-				 symtab_t*,_Bool);
+				 symbol_t*,_Bool);
 
 #endif
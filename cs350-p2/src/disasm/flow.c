@@ -0,0 +1,292 @@
+/* ************************************************************************* *
+ * flow.c                                                                    *
+ * ------                                                                    *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Tell code from data without a symbol file (-r).  The program   *
+ *            is followed from its first byte through every branch and       *
+ *            call whose target is known, and what is never reached is data. *
+ *            The result is a symbol table like the one a symlist file       *
+ *            gives, so the rest of the disassembler is unchanged:           *
+ *                                                                           *
+ *              - branch and call targets get a LINE label, L<address>       *
+ *              - data that an instruction names directly or as the base of  *
+ *                an indexed operand gets a label, D<address>, and a         *
+ *                directive of the size that instruction reads: .WORD, a     *
+ *                one-byte .BLOCK, or .ASCII for STRO                        *
+ *              - other data becomes .BLOCK for runs of zeros, .ASCII for    *
+ *                printable text ending in a zero byte, and .WORD (or a      *
+ *                last .BLOCK 1) for the rest; these have no label           *
+ *                                                                           *
+ *            Every address is decoded at most once, so the whole pass is    *
+ *            linear in the size of the image.                               *
+ * ************************************************************************* */
+
+
+/* ************************************************************************* *
+ * Library includes here.                                                    *
+ * ************************************************************************* */
+
+#include <stdio.h>              /* standard I/O */
+#include <stdint.h>             /* uint8_t */
+#include <stdbool.h>		/* bool types */
+#include <stdlib.h>		/* malloc */
+#include <string.h>		/* strlen */
+#include <ctype.h>		/* isprint */
+
+#include "flow.h"		/* header file */
+#include "disasm.h"		/* unary_specifier */
+#include "../symbol/sym.h"	/* symtab_add */
+
+/* ************************************************************************* *
+ * Global variable declarations                                              *
+ * ************************************************************************* */
+
+/* What the walk learns about each byte of the image */
+#define FLOW_CODE	0x01 //part of an instruction that can be reached
+#define FLOW_START	0x02 //a reached instruction starts here
+#define FLOW_TARGET	0x04 //a branch or call goes here
+#define FLOW_QUEUED	0x08 //already on the worklist
+#define FLOW_BYTE_REF	0x10 //read or written a byte at a time
+#define FLOW_WORD_REF	0x20 //read or written a word at a time
+#define FLOW_STRING_REF	0x40 //printed with STRO
+#define FLOW_REF	(FLOW_BYTE_REF | FLOW_WORD_REF | FLOW_STRING_REF)
+
+/* ************************************************************************* *
+ * Purpose: Add a symbol to the end of the table                             *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      symtab: the table being built, in address order                      *
+ *      prefix: 'L' or 'D' for a label made from the address, 0 for none     *
+ *      type: what the symbol is                                             *
+ *      offset: where it is in the image                                     *
+ *      address: where that is in memory, for the label                      *
+ *      length: the .BLOCK length                                            *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      int: 0 if success, 1 if out of memory                                *
+ * ************************************************************************* */
+static int add_symbol(symtab_t* symtab,char prefix,symtype_t type,
+		      int offset,uint16_t address,size_t length)
+{
+    char label[8];
+    if (prefix == 0)
+	return symtab_add(symtab,NULL,0,type,offset,length);
+    snprintf(label,sizeof(label),"%c%04X",prefix,address);
+    return symtab_add(symtab,label,strlen(label),type,offset,length);
+}
+
+/* ************************************************************************* *
+ * Purpose: Follow the program from its first byte                           *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      image: the program                                                   *
+ *      mem_length: its length                                               *
+ *      origin: the address it is loaded at; operands are absolute           *
+ *      flags: one byte per image byte, zeroed, receives FLOW_ bits          *
+ *      worklist: room for mem_length addresses                              *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      A path ends at STOP, RETTR, RETn, BR, or an instruction whose        *
+ *      operand specifier would run off the end of the image (the listing    *
+ *      shows that as data).  Indexed branches end nothing but add no        *
+ *      target, since where they go is not known until the program runs.     *
+ * ************************************************************************* */
+static void follow_flow(uint8_t* image,int mem_length,uint16_t origin,
+			uint8_t* flags,int* worklist)
+{
+    int pending = 0;
+    worklist[pending++] = 0;
+    flags[0] |= FLOW_QUEUED;
+    while (pending > 0)
+    {
+	int index = worklist[--pending];
+	while (index < mem_length && !(flags[index] & FLOW_START))
+	{
+	    uint8_t op = image[index];
+	    bool unary = unary_specifier(op);
+	    if (!unary && index + 2 >= mem_length)
+		break;
+	    flags[index] |= FLOW_START | FLOW_CODE;
+	    if (unary)
+	    {
+		if (op <= 0x01 || op >= 0x58) //STOP, RETTR, RETn
+		    break;
+		index++;
+		continue;
+	    }
+	    flags[index + 1] |= FLOW_CODE;
+	    flags[index + 2] |= FLOW_CODE;
+
+	    uint16_t operand = (image[index + 1] << 8) | image[index + 2];
+	    int at = (uint16_t)(operand - origin); //operand within the image
+	    if (op >= 0x04 && op <= 0x17) //BR, BRxx, CALL
+	    {
+		if ((op & 0x01) == 0 && at < mem_length) //immediate target
+		{
+		    flags[at] |= FLOW_TARGET;
+		    if (!(flags[at] & FLOW_QUEUED))
+		    {
+			flags[at] |= FLOW_QUEUED;
+			worklist[pending++] = at;
+		    }
+		}
+		if (op <= 0x05) //BR never falls through
+		    break;
+	    }
+	    else if (op >= 0x28 && at < mem_length &&
+		     ((op & 0x07) == 1 || (op & 0x07) == 5)) //direct, indexed
+	    {
+		if (op >= 0x40 && op <= 0x47) //STRO
+		    flags[at] |= FLOW_STRING_REF;
+		else if ((op >= 0x48 && op <= 0x57) || //CHARI, CHARO
+			 (op >= 0xD0 && op <= 0xDF) || //LDBYTEr
+			 op >= 0xF0) //STBYTEr
+		    flags[at] |= FLOW_BYTE_REF;
+		else
+		    flags[at] |= FLOW_WORD_REF;
+	    }
+	    index += 3;
+	}
+    }
+}
+
+/* ************************************************************************* *
+ * Purpose: Describe a run of data bytes as directives                       *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      symtab: receives the directives                                      *
+ *      image: the program                                                   *
+ *      flags: what follow_flow found                                        *
+ *      start: the first data byte                                           *
+ *      end: the first byte after the run                                    *
+ *      origin: the address the image is loaded at                           *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      int: 0 if success, 1 if out of memory                                *
+ * ************************************************************************* */
+static int add_data(symtab_t* symtab,uint8_t* image,uint8_t* flags,
+		    int start,int end,uint16_t origin)
+{
+    int index = start;
+    while (index < end)
+    {
+	char prefix = (flags[index] & FLOW_REF) ? 'D' : 0;
+	uint16_t address = origin + index;
+	int next = index + 1; //the next referenced byte, or end
+	while (next < end && !(flags[next] & FLOW_REF))
+	    next++;
+	int nul = index; //the first zero byte from here, or end
+	while (nul < end && image[nul] != 0)
+	    nul++;
+	int text = index; //how far the printable bytes go
+	while (text < end && isprint(image[text]))
+	    text++;
+	int zeros = index; //how far the zero bytes go
+	while (zeros < next && image[zeros] == 0)
+	    zeros++;
+
+	int length = 0;
+	symtype_t type = WORD;
+	if ((flags[index] & FLOW_STRING_REF) && nul < end)
+	{
+	    type = ASCII;
+	    length = nul + 1 - index;
+	}
+	else if ((flags[index] & FLOW_WORD_REF) && next - index >= 2)
+	    length = 2;
+	else if (zeros == next)
+	{
+	    type = BLOCK;
+	    length = next - index;
+	}
+	else if (text == nul && nul < next && nul - index >= 3)
+	{
+	    type = ASCII;
+	    length = nul + 1 - index;
+	}
+	else if (next - index >= 2)
+	    length = 2;
+	else
+	{
+	    type = BLOCK;
+	    length = 1;
+	}
+
+	if (add_symbol(symtab,prefix,type,index,address,length))
+	    return 1;
+	index += length;
+    }
+    return 0;
+}
+
+/* ************************************************************************* *
+ * discover_symbols -- makes up a symbol table by following the program      *
+ *                                                                           *
+ * Parameters                                                                *
+ *   image -- the program                                                    *
+ *   mem_length -- its length                                                *
+ *   origin -- the address it is loaded at                                   *
+ *   symtab -- receives the symbols, in address order, as                    *
+ *             symlist_open_and_read would give them                         *
+ *                                                                           *
+ * Returns                                                                   *
+ *    0 - if success                                                         *
+ *    1 - if failure                                                         *
+ *                                                                           *
+ * Notes                                                                     *
+ *    The symbols are placed where the disassembler will look for them: the  *
+ *    image is swept in the same order determine_instructions decodes it,    *
+ *    so every directive starts where the one before it ends even when two   *
+ *    reachable instructions overlap.                                        *
+ * ************************************************************************* */
+int discover_symbols(uint8_t* image,int mem_length,uint16_t origin,
+		     symtab_t** symtab)
+{
+    symtab_t* table = symtab_create();
+    uint8_t* flags = calloc(mem_length,sizeof(uint8_t));
+    int* worklist = malloc(mem_length * sizeof(int));
+    int status = 0;
+    if (table == NULL || flags == NULL || worklist == NULL)
+    {
+	printf("Error No memory allocated");
+	symtab_free(table);
+	free(flags);
+	free(worklist);
+	return 1;
+    }
+
+    follow_flow(image,mem_length,origin,flags,worklist);
+
+    int index = 0;
+    while (index < mem_length && status == 0)
+    {
+	int end = index;
+	if (flags[index] & FLOW_CODE)
+	{
+	    bool unary = unary_specifier(image[index]);
+	    if (unary || index + 2 < mem_length)
+	    {
+		if (flags[index] & FLOW_TARGET)
+		    status = add_symbol(table,'L',LINE,index,origin + index,0);
+		index += unary ? 1 : 3;
+		continue;
+	    }
+	    end = mem_length; //an operand would run off the end: data
+	}
+	while (end < mem_length && !(flags[end] & FLOW_CODE))
+	    end++;
+	status = add_data(table,image,flags,index,end,origin);
+	index = end;
+    }
+
+    free(flags);
+    free(worklist);
+    if (status)
+    {
+	printf("Error No memory allocated");
+	symtab_free(table);
+	return 1;
+    }
+    *symtab = table;
+    return 0;
+}
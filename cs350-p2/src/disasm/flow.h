@@ -0,0 +1,9 @@
+#ifndef __DISASM_FLOW__
+#define __DISASM_FLOW__
+
+#include "disasm.h"		/* symtab_t */
+
+/*Prototypes*/
+int discover_symbols(uint8_t*,int,uint16_t,symtab_t**);
+
+#endif
@@ -0,0 +1,212 @@
+/* ************************************************************************* *
+ * parallel.c                                                                *
+ * ----------                                                                *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Disassemble a large image on several threads (-j N).  The      *
+ *            image is cut into one chunk per thread, each chunk is decoded  *
+ *            on its own from its first address, and the chunks are joined   *
+ *            in address order into exactly the list that                    *
+ *            determine_instructions would have made.                        *
+ *                                                                           *
+ *            A chunk's first address is only a guess at an instruction      *
+ *            boundary: a symbol if one falls in the right place, otherwise  *
+ *            wherever the split lands.  When the chunk before it ends       *
+ *            somewhere else, the join decodes one instruction at a time     *
+ *            from there until it reaches an address the chunk also decoded. *
+ *            Decoding an address depends on nothing but the address, so     *
+ *            from that point on the chunk's records are the serial ones.    *
+ * ************************************************************************* */
+
+
+/* ************************************************************************* *
+ * Library includes here.                                                    *
+ * ************************************************************************* */
+
+#include <stdio.h>              /* standard I/O */
+#include <stdint.h>             /* uint8_t */
+#include <stdbool.h>		/* bool types */
+#include <stdlib.h>		/* malloc */
+#include <pthread.h>		/* pthread_create */
+
+#include "parallel.h"		/* header file */
+#include "disasm.h"		/* decode_instruction */
+
+/* ************************************************************************* *
+ * Global variable declarations                                              *
+ * ************************************************************************* */
+
+/* One thread's share of the image */
+typedef struct chunk {
+    uint8_t* memory; //the image
+    int mem_length; //its length
+    const symtab_index_t* symbols; //the symbol table by address, or NULL
+    int start; //first address decoded
+    int limit; //decoding stops at the first address at or past this
+    inst_list_t list; //what was decoded, in address order
+    int end; //the address after the last record, or where decoding failed
+    decode_status_t status; //DECODE_OK unless decoding failed at end
+} chunk_t;
+
+/* ************************************************************************* *
+ * Purpose: Decode one chunk; the body of each thread                        *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      arg: the chunk_t to fill in                                          *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      An error is recorded rather than reported, because the chunk may     *
+ *      have started somewhere the serial decode never goes.                 *
+ * ************************************************************************* */
+static void* decode_chunk(void* arg)
+{
+    chunk_t* chunk = arg;
+    int index = chunk->start;
+    chunk->status = DECODE_OK;
+    inst_list_init(&chunk->list,(chunk->limit - chunk->start) / 3 + 1);
+    while (index < chunk->limit)
+    {
+	chunk->status = decode_instruction(chunk->memory,chunk->mem_length,
+					   chunk->symbols,index,
+					   inst_list_append(&chunk->list),
+					   &index);
+	if (chunk->status != DECODE_OK)
+	{
+	    chunk->list.count--; //the record it was filling in
+	    break;
+	}
+    }
+    chunk->end = index;
+    return NULL;
+}
+
+/* ************************************************************************* *
+ * Purpose: Pick where a chunk starts                                        *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      symbols: the symbol table by address, or NULL                        *
+ *      split: the even split point                                          *
+ *      next_split: the split point after it                                 *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      int: the first symbol at or after split and before next_split, which *
+ *           is where a listing most likely has a boundary; split if none    *
+ * ************************************************************************* */
+static int chunk_start(const symtab_index_t* symbols,int split,int next_split)
+{
+    int index = 0;
+    for (index = split; symbols != NULL && index < next_split; index++)
+    {
+	if (symbols->at[index] != NULL)
+	    return index;
+    }
+    return split;
+}
+
+/* ************************************************************************* *
+ * Purpose: Add a chunk's records from the one at an address onward          *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      instructions: the list being joined                                  *
+ *      chunk: the chunk                                                     *
+ *      first: index of the first record to add                              *
+ * ************************************************************************* */
+static void append_chunk(inst_list_t* instructions,chunk_t* chunk,
+			 size_t first)
+{
+    size_t i = 0;
+    for (i = first; i < chunk->list.count; i++)
+	*inst_list_append(instructions) = chunk->list.items[i];
+}
+
+/* ************************************************************************* *
+ * Purpose: To determine all of the instructions in memory on several        *
+ *          threads                                                          *
+ *                                                                           *
+ * Parameters:                                                               *
+ *     instructions- receives the instructions, in address order             *
+ *     memory- the array of bytes read from file                             *
+ *     mem_length- the number of bytes in memory                             *
+ *     symbols- the symbol table by address, or NULL if there is none        *
+ *     threads- how many threads to decode on; 1 or less decodes serially    *
+ *                                                                           *
+ * Notes:                                                                    *
+ *     The list and any error are the same as determine_instructions         *
+ *     gives.  The calling thread decodes the first chunk itself; if a       *
+ *     thread cannot be started its chunk is decoded there too.              *
+ * ************************************************************************* */
+void determine_instructions_parallel(inst_list_t* instructions,
+				     uint8_t* memory,int mem_length,
+				     const symtab_index_t* symbols,
+				     unsigned threads)
+{
+    if (threads > MAX_DECODE_THREADS)
+	threads = MAX_DECODE_THREADS;
+    if (threads > (unsigned)mem_length)
+	threads = mem_length;
+    if (threads <= 1)
+    {
+	determine_instructions(instructions,memory,mem_length,symbols);
+	return;
+    }
+
+    chunk_t chunks[MAX_DECODE_THREADS];
+    pthread_t ids[MAX_DECODE_THREADS];
+    bool started[MAX_DECODE_THREADS];
+    unsigned k = 0;
+    for (k = 0; k < threads; k++)
+    {
+	int split = (int)((int64_t)mem_length * k / threads);
+	int next_split = (int)((int64_t)mem_length * (k + 1) / threads);
+	chunks[k].memory = memory;
+	chunks[k].mem_length = mem_length;
+	chunks[k].symbols = symbols;
+	chunks[k].start = k == 0 ? 0 : chunk_start(symbols,split,next_split);
+    }
+    for (k = 0; k < threads; k++)
+	chunks[k].limit = k + 1 < threads ? chunks[k + 1].start : mem_length;
+
+    for (k = 1; k < threads; k++)
+	started[k] = pthread_create(&ids[k],NULL,decode_chunk,&chunks[k]) == 0;
+    decode_chunk(&chunks[0]);
+    size_t total = chunks[0].list.count;
+    for (k = 1; k < threads; k++)
+    {
+	if (started[k])
+	    pthread_join(ids[k],NULL);
+	else
+	    decode_chunk(&chunks[k]);
+	total += chunks[k].list.count;
+    }
+
+    //join the chunks, decoding serially wherever one did not start in step
+    int index = 0; //how far the serial decode has got
+    decode_status_t status;
+    inst_list_init(instructions,total + 1);
+    for (k = 0; k < threads; k++)
+    {
+	chunk_t* chunk = &chunks[k];
+	size_t first = 0;
+	while (index < chunk->limit)
+	{
+	    while (first < chunk->list.count &&
+		   chunk->list.items[first].addr < index)
+		first++;
+	    if ((first < chunk->list.count &&
+		 chunk->list.items[first].addr == index) ||
+		index == chunk->end)
+	    {
+		//in step: the rest of the chunk is what serial would decode
+		append_chunk(instructions,chunk,first);
+		index = chunk->end;
+		if (chunk->status != DECODE_OK)
+		    report_decode_error(chunk->status,memory[index]);
+		break;
+	    }
+	    status = decode_instruction(memory,mem_length,symbols,index,
+					inst_list_append(instructions),&index);
+	    if (status != DECODE_OK)
+		report_decode_error(status,memory[index]);
+	}
+	inst_list_free(&chunk->list);
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef __DISASM_PARALLEL__
+#define __DISASM_PARALLEL__
+
+#include "disasm.h"		/* inst_list_t, symtab_index_t */
+
+/* Most threads -j accepts */
+#define MAX_DECODE_THREADS 64
+
+/*Prototypes*/
+void determine_instructions_parallel(inst_list_t*,uint8_t*,int,
+				     const symtab_index_t*,unsigned);
+
+#endif
@@ -0,0 +1,611 @@
+/* ************************************************************************* *
+ * result-cache.c                                                            *
+ * --------------                                                            *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  On-disk cache of disassemblies (-C DIR).  The instruction list *
+ *            and symbol table of a run are stored in DIR under a hash of    *
+ *            the image and the symlist, and a later run on the same bytes   *
+ *            copies the tables back out of that entry and rebuilds the      *
+ *            address index instead of reading the symlist and decoding.     *
+ *                                                                           *
+ *            An entry holds its own copy of the image and symlist, and a    *
+ *            hit compares them in full, so two inputs whose hashes collide  *
+ *            can never share a result.  Entries are written to a temporary  *
+ *            name and renamed into place, so a reader never sees half of    *
+ *            one.  The directory keeps running totals of hits, misses and   *
+ *            time saved in DIR/stats for -t.                                *
+ * ************************************************************************* */
+
+
+/* ************************************************************************* *
+ * Library includes here.                                                    *
+ * ************************************************************************* */
+
+#include <stdio.h>              /* standard I/O */
+#include <stdint.h>             /* uint8_t, uint64_t */
+#include <stdbool.h>		/* bool types */
+#include <stdlib.h>		/* malloc, qsort */
+#include <string.h>		/* memcmp, strlen */
+#include <inttypes.h>		/* PRIx64, SCNu64 */
+#include <errno.h>		/* EEXIST */
+#include <fcntl.h>		/* open, AT_FDCWD */
+#include <unistd.h>		/* read, close, unlink */
+#include <dirent.h>		/* opendir */
+#include <sys/stat.h>		/* mkdir, fstat, utimensat */
+#include <sys/mman.h>		/* mmap */
+
+#include "result-cache.h"	/* header file */
+#include "../symbol/sym.h"	/* symtab_index_build */
+#include "../main/timer.h"	/* timer_now */
+
+/* ************************************************************************* *
+ * Global variable declarations                                              *
+ * ************************************************************************* */
+#define RESULT_CACHE_MAGIC "PEP8RC03"
+#define RESULT_CACHE_SYMLIST	0x01 //the symbols came from a symlist file
+#define RESULT_CACHE_RECURSIVE	0x02 //the symbols came from -r
+
+#define ALIGN8(n) (((n) + 7) & ~(size_t)7)
+
+/* An entry file, in this machine's byte order; only this program on this
+ * machine reads it back, and inst_size catches a changed instruction_t.
+ *   header
+ *   image (image_length bytes), then the symlist (symlist_length bytes)
+ *   the symtab's symbol_t records, 8-byte aligned, in symbol list order
+ *   instructions, 8-byte aligned, with symb holding a symbol's place in
+ *      that order plus one, or 0
+ *   strings: the symtab's string pool, as symbol_t.label indexes it */
+typedef struct entry_header {
+    char magic[8];
+    uint32_t inst_size; //sizeof(instruction_t)
+    uint32_t mode; //RESULT_CACHE_* bits
+    uint32_t image_length;
+    uint32_t symlist_length;
+    uint32_t symbol_count;
+    uint32_t inst_count;
+    uint32_t strings_length;
+    uint16_t origin;
+    uint16_t unused;
+    double decode_seconds; //what making this result took
+} entry_header_t;
+
+/* Where each part of an entry starts */
+typedef struct entry_layout {
+    size_t image;
+    size_t symlist;
+    size_t symbols;
+    size_t instructions;
+    size_t strings;
+    size_t size; //the whole entry
+} entry_layout_t;
+
+/* Running totals kept in DIR/stats */
+typedef struct cache_stats {
+    uint64_t hits;
+    uint64_t misses;
+    double seconds_saved;
+} cache_stats_t;
+
+/* An entry file found by evict, for sorting by last use */
+typedef struct entry_file {
+    char name[32];
+    off_t size;
+    struct timespec used;
+} entry_file_t;
+
+/* ************************************************************************* *
+ * Purpose: Add bytes to a 64-bit FNV-1a hash                                *
+ * ************************************************************************* */
+static uint64_t hash_bytes(uint64_t hash,const void* bytes,size_t length)
+{
+    const uint8_t* at = bytes;
+    size_t i = 0;
+    for (i = 0; i < length; i++)
+    {
+	hash ^= at[i];
+	hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+/* ************************************************************************* *
+ * Purpose: Work out where each part of an entry goes                        *
+ * ************************************************************************* */
+static void entry_layout(const entry_header_t* header,entry_layout_t* layout)
+{
+    layout->image = sizeof(entry_header_t);
+    layout->symlist = layout->image + header->image_length;
+    layout->symbols = ALIGN8(layout->symlist + header->symlist_length);
+    layout->instructions = ALIGN8(layout->symbols +
+	(size_t)header->symbol_count * sizeof(symbol_t));
+    layout->strings = layout->instructions +
+	(size_t)header->inst_count * sizeof(instruction_t);
+    layout->size = layout->strings + header->strings_length;
+}
+
+/* ************************************************************************* *
+ * Purpose: Read a whole file                                                *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      filename: the file                                                   *
+ *      bytes: receives its contents, to be freed                            *
+ *      length: receives its length                                          *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      int: 0 if success, 1 if the file cannot be read                      *
+ * ************************************************************************* */
+static int read_file(const char* filename,uint8_t** bytes,size_t* length)
+{
+    struct stat st;
+    int fd = open(filename,O_RDONLY);
+    if (fd < 0)
+	return 1;
+    if (fstat(fd,&st) != 0 || (*bytes = malloc(st.st_size + 1)) == NULL)
+    {
+	close(fd);
+	return 1;
+    }
+    *length = 0;
+    while (*length < (size_t)st.st_size)
+    {
+	ssize_t got = read(fd,*bytes + *length,st.st_size - *length);
+	if (got <= 0)
+	    break;
+	*length += got;
+    }
+    close(fd);
+    return 0;
+}
+
+/* ************************************************************************* *
+ * Purpose: Read and update the running totals in DIR/stats                  *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      The file is replaced by rename, so it is never half written; two     *
+ *      runs finishing at once can lose one of their counts.                 *
+ * ************************************************************************* */
+static void read_stats(const char* dir,cache_stats_t* stats)
+{
+    char path[FILENAME_MAX];
+    FILE* fp = NULL;
+    memset(stats,0,sizeof(cache_stats_t));
+    snprintf(path,sizeof(path),"%s/stats",dir);
+    fp = fopen(path,"r");
+    if (fp == NULL)
+	return;
+    if (fscanf(fp,"hits %" SCNu64 " misses %" SCNu64 " saved %lf",
+	       &stats->hits,&stats->misses,&stats->seconds_saved) != 3)
+	memset(stats,0,sizeof(cache_stats_t));
+    fclose(fp);
+}
+
+static void update_stats(const char* dir,uint64_t hits,uint64_t misses,
+			 double seconds_saved)
+{
+    char path[FILENAME_MAX];
+    char temp[FILENAME_MAX];
+    cache_stats_t stats;
+    read_stats(dir,&stats);
+    stats.hits += hits;
+    stats.misses += misses;
+    stats.seconds_saved += seconds_saved;
+
+    snprintf(path,sizeof(path),"%s/stats",dir);
+    snprintf(temp,sizeof(temp),"%s/.statsXXXXXX",dir);
+    int fd = mkstemp(temp);
+    if (fd < 0)
+	return;
+    FILE* fp = fdopen(fd,"w");
+    if (fp == NULL)
+    {
+	close(fd);
+	unlink(temp);
+	return;
+    }
+    fprintf(fp,"hits %" PRIu64 "\nmisses %" PRIu64 "\nsaved %.6f\n",
+	    stats.hits,stats.misses,stats.seconds_saved);
+    if (fclose(fp) != 0 || rename(temp,path) != 0)
+	unlink(temp);
+}
+
+/* ************************************************************************* *
+ * result_cache_open -- works out which entry belongs to this run            *
+ *                                                                           *
+ * Parameters                                                                *
+ *   cache -- filled in for the other result_cache_ functions                *
+ *   dir -- the cache directory, made if it does not exist                   *
+ *   image -- the program                                                    *
+ *   image_length -- its length                                              *
+ *   origin -- the address it is loaded at                                   *
+ *   symlist -- the symlist file given with -s, or NULL                      *
+ *   recursive -- whether -r makes the symbols up                            *
+ *                                                                           *
+ * Returns                                                                   *
+ *    0 - if success                                                         *
+ *    1 - if the directory cannot be made                                    *
+ *                                                                           *
+ * Notes                                                                     *
+ *    A symlist that cannot be read turns the cache off for this run, so     *
+ *    symlist_open_and_read reports it as it always has.                     *
+ * ************************************************************************* */
+int result_cache_open(result_cache_t* cache,const char* dir,uint8_t* image,
+		      int image_length,uint16_t origin,const char* symlist,
+		      _Bool recursive)
+{
+    memset(cache,0,sizeof(result_cache_t));
+    cache->image = image;
+    cache->image_length = image_length;
+    cache->origin = origin;
+    cache->mode = (symlist != NULL ? RESULT_CACHE_SYMLIST : 0) |
+		  (recursive ? RESULT_CACHE_RECURSIVE : 0);
+    if (symlist != NULL &&
+	read_file(symlist,&cache->symlist,&cache->symlist_length))
+	return 0; //dir stays NULL: no cache
+
+    if (mkdir(dir,0777) != 0 && errno != EEXIST)
+    {
+	printf("Cannot use cache directory \"%s\"\n",dir);
+	free(cache->symlist);
+	cache->symlist = NULL;
+	return 1;
+    }
+    cache->dir = dir;
+
+    uint64_t key = 0xCBF29CE484222325ULL; //FNV-1a offset basis
+    key = hash_bytes(key,&cache->mode,sizeof(cache->mode));
+    key = hash_bytes(key,&cache->origin,sizeof(cache->origin));
+    key = hash_bytes(key,&cache->image_length,sizeof(cache->image_length));
+    key = hash_bytes(key,image,image_length);
+    key = hash_bytes(key,cache->symlist,cache->symlist_length);
+    snprintf(cache->path,sizeof(cache->path),"%s/%016" PRIx64 ".dis",dir,key);
+    return 0;
+}
+
+/* ************************************************************************* *
+ * Purpose: Check an entry header against this run and the file size         *
+ * ************************************************************************* */
+static _Bool entry_matches(result_cache_t* cache,const uint8_t* entry,
+			   size_t size,entry_layout_t* layout)
+{
+    const entry_header_t* header = (const entry_header_t*)entry;
+    if (size < sizeof(entry_header_t) ||
+	memcmp(header->magic,RESULT_CACHE_MAGIC,8) != 0 ||
+	header->inst_size != sizeof(instruction_t) ||
+	header->mode != cache->mode || header->origin != cache->origin ||
+	header->image_length != (uint32_t)cache->image_length ||
+	header->symlist_length != cache->symlist_length)
+	return false;
+    entry_layout(header,layout);
+    if (layout->size != size ||
+	(header->strings_length > 0 && entry[size - 1] != '\0'))
+	return false;
+    return memcmp(entry + layout->image,cache->image,
+		  cache->image_length) == 0 &&
+	   memcmp(entry + layout->symlist,cache->symlist,
+		  cache->symlist_length) == 0;
+}
+
+/* ************************************************************************* *
+ * Purpose: Rebuild the symbol table and instruction list from an entry      *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      int: 0 if success, 1 if the entry is damaged or out of memory        *
+ * ************************************************************************* */
+static int entry_read(const uint8_t* entry,entry_layout_t* layout,
+		      symtab_t** symtab,symtab_index_t** symbols,
+		      inst_list_t* instructions)
+{
+    const entry_header_t* header = (const entry_header_t*)entry;
+    uint32_t count = header->symbol_count;
+    uint32_t i = 0;
+    *symtab = NULL;
+    *symbols = NULL;
+    symtab_t* table = count > 0 ? calloc(1,sizeof(symtab_t)) : NULL;
+    if (count > 0)
+    {
+	if (table == NULL ||
+	    (table->symbols = malloc(count * sizeof(symbol_t))) == NULL ||
+	    (table->strings = malloc(header->strings_length)) == NULL)
+	{
+	    symtab_free(table);
+	    return 1;
+	}
+	memcpy(table->symbols,entry + layout->symbols,count * sizeof(symbol_t));
+	memcpy(table->strings,entry + layout->strings,header->strings_length);
+	table->count = table->capacity = count;
+	table->strings_length = table->strings_capacity =
+	    header->strings_length;
+	for (i = 0; i < count; i++)
+	{
+	    if (table->symbols[i].label >= header->strings_length ||
+		table->symbols[i].type >= NUMBER_OF_SYMTYPES)
+	    {
+		symtab_free(table);
+		return 1;
+	    }
+	}
+    }
+
+    inst_list_init(instructions,header->inst_count + 1);
+    memcpy(instructions->items,entry + layout->instructions,
+	   (size_t)header->inst_count * sizeof(instruction_t));
+    instructions->count = header->inst_count;
+    for (i = 0; i < header->inst_count; i++)
+    {
+	uintptr_t number = (uintptr_t)instructions->items[i].symb;
+	if (number > count)
+	{
+	    inst_list_free(instructions);
+	    symtab_free(table);
+	    return 1;
+	}
+	instructions->items[i].symb = number != 0 ?
+	    &table->symbols[number - 1] : NULL;
+    }
+
+    if (count > 0 && (*symbols = symtab_index_build(table)) == NULL)
+    {
+	inst_list_free(instructions);
+	symtab_free(table);
+	return 1;
+    }
+    *symtab = table;
+    return 0;
+}
+
+/* ************************************************************************* *
+ * result_cache_load -- looks for this run's result in the cache             *
+ *                                                                           *
+ * Parameters                                                                *
+ *   cache -- from result_cache_open                                         *
+ *   symtab -- receives the symbol table, as symlist_open_and_read or        *
+ *             discover_symbols would give it                                *
+ *   symbols -- receives its index by address                                *
+ *   instructions -- receives the instruction list, as                       *
+ *                   determine_instructions would give it                    *
+ *                                                                           *
+ * Returns                                                                   *
+ *    true - on a hit; nothing else needs to be decoded or read              *
+ *    false - on a miss; the outputs are untouched                           *
+ *                                                                           *
+ * Notes                                                                     *
+ *    A hit marks the entry as just used, which is what eviction goes by.    *
+ *    A damaged entry is a miss and is replaced by result_cache_store.       *
+ * ************************************************************************* */
+_Bool result_cache_load(result_cache_t* cache,symtab_t** symtab,
+			symtab_index_t** symbols,inst_list_t* instructions)
+{
+    struct stat st;
+    entry_layout_t layout;
+    if (cache->dir == NULL)
+	return false;
+    double start = timer_now();
+    int fd = open(cache->path,O_RDONLY);
+    if (fd < 0)
+	return false;
+    if (fstat(fd,&st) != 0 || st.st_size == 0)
+    {
+	close(fd);
+	return false;
+    }
+    uint8_t* entry = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if (entry == MAP_FAILED)
+	return false;
+
+    cache->hit = entry_matches(cache,entry,st.st_size,&layout) &&
+		 entry_read(entry,&layout,symtab,symbols,instructions) == 0;
+    double decode_seconds = ((const entry_header_t*)entry)->decode_seconds;
+    munmap(entry,st.st_size);
+    if (!cache->hit)
+	return false;
+
+    utimensat(AT_FDCWD,cache->path,NULL,0); //used now
+    cache->seconds_saved = decode_seconds - (timer_now() - start);
+    update_stats(cache->dir,1,0,cache->seconds_saved);
+    return true;
+}
+
+/* ************************************************************************* *
+ * Purpose: Order entry files from least to most recently used               *
+ * ************************************************************************* */
+static int compare_use(const void* a,const void* b)
+{
+    const entry_file_t* left = a;
+    const entry_file_t* right = b;
+    if (left->used.tv_sec != right->used.tv_sec)
+	return left->used.tv_sec < right->used.tv_sec ? -1 : 1;
+    if (left->used.tv_nsec != right->used.tv_nsec)
+	return left->used.tv_nsec < right->used.tv_nsec ? -1 : 1;
+    return 0;
+}
+
+/* ************************************************************************* *
+ * Purpose: Remove the least recently used entries until the directory is    *
+ *          within RESULT_CACHE_MAX_BYTES and RESULT_CACHE_MAX_ENTRIES       *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      cache: the run that just stored its entry, which is kept             *
+ * ************************************************************************* */
+static void evict(result_cache_t* cache)
+{
+    DIR* dir = opendir(cache->dir);
+    struct dirent* found = NULL;
+    entry_file_t* files = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    uint64_t total = 0;
+    const char* keep = strrchr(cache->path,'/') + 1;
+    if (dir == NULL)
+	return;
+    while ((found = readdir(dir)) != NULL)
+    {
+	char path[FILENAME_MAX];
+	struct stat st;
+	size_t length = strlen(found->d_name);
+	if (length != 20 || strcmp(found->d_name + 16,".dis") != 0)
+	    continue;
+	snprintf(path,sizeof(path),"%s/%s",cache->dir,found->d_name);
+	if (stat(path,&st) != 0)
+	    continue;
+	if (count == capacity)
+	{
+	    capacity = capacity ? capacity * 2 : 64;
+	    entry_file_t* grown = realloc(files,capacity * sizeof(entry_file_t));
+	    if (grown == NULL)
+		break;
+	    files = grown;
+	}
+	memcpy(files[count].name,found->d_name,length + 1);
+	files[count].size = st.st_size;
+	files[count].used = st.st_mtim;
+	total += st.st_size;
+	count++;
+    }
+    closedir(dir);
+
+    qsort(files,count,sizeof(entry_file_t),compare_use);
+    size_t i = 0;
+    size_t left = count;
+    for (i = 0; i < count && (total > RESULT_CACHE_MAX_BYTES ||
+			      left > RESULT_CACHE_MAX_ENTRIES); i++)
+    {
+	char path[FILENAME_MAX];
+	if (strcmp(files[i].name,keep) == 0)
+	    continue;
+	snprintf(path,sizeof(path),"%s/%s",cache->dir,files[i].name);
+	if (unlink(path) == 0)
+	{
+	    total -= files[i].size;
+	    left--;
+	}
+    }
+    free(files);
+}
+
+/* ************************************************************************* *
+ * result_cache_store -- saves this run's result for later runs              *
+ *                                                                           *
+ * Parameters                                                                *
+ *   cache -- from result_cache_open, after a miss                           *
+ *   symtab -- the symbol table, NULL if there is none                       *
+ *   symbols -- its index by address                                         *
+ *   instructions -- the instruction list                                    *
+ *   seconds -- how long reading the symbols and decoding took               *
+ *                                                                           *
+ * Notes                                                                     *
+ *    The cache only saves time, so an entry that cannot be written is       *
+ *    skipped without a message.  The symbol records and string pool are     *
+ *    written as they are in memory; symb becomes a place in the array.      *
+ * ************************************************************************* */
+void result_cache_store(result_cache_t* cache,symtab_t* symtab,
+			const symtab_index_t* symbols,
+			inst_list_t* instructions,double seconds)
+{
+    entry_header_t header;
+    entry_layout_t layout;
+    char temp[FILENAME_MAX];
+    size_t i = 0;
+    if (cache->dir == NULL)
+	return;
+    update_stats(cache->dir,0,1,0);
+
+    memset(&header,0,sizeof(header));
+    memcpy(header.magic,RESULT_CACHE_MAGIC,8);
+    header.inst_size = sizeof(instruction_t);
+    header.mode = cache->mode;
+    header.image_length = cache->image_length;
+    header.symlist_length = cache->symlist_length;
+    header.inst_count = instructions->count;
+    header.origin = cache->origin;
+    header.decode_seconds = seconds;
+    if (symtab != NULL)
+    {
+	header.symbol_count = symtab->count;
+	header.strings_length = symtab->strings_length;
+    }
+    entry_layout(&header,&layout);
+
+    snprintf(temp,sizeof(temp),"%s/.entryXXXXXX",cache->dir);
+    int fd = mkstemp(temp);
+    FILE* fp = fd >= 0 ? fdopen(fd,"wb") : NULL;
+    if (fp == NULL)
+    {
+	if (fd >= 0)
+	{
+	    close(fd);
+	    unlink(temp);
+	}
+	return;
+    }
+
+    static const uint8_t zeros[8] = {0};
+    bool ok = true;
+    fwrite(&header,sizeof(header),1,fp);
+    fwrite(cache->image,1,cache->image_length,fp);
+    fwrite(cache->symlist,1,cache->symlist_length,fp);
+    fwrite(zeros,1,layout.symbols - (layout.symlist + cache->symlist_length),
+	   fp);
+    if (symtab != NULL)
+	fwrite(symtab->symbols,sizeof(symbol_t),symtab->count,fp);
+    fwrite(zeros,1,layout.instructions - (layout.symbols +
+	   (size_t)header.symbol_count * sizeof(symbol_t)),fp);
+
+    for (i = 0; i < instructions->count && ok; i++)
+    {
+	instruction_t stored = instructions->items[i];
+	uintptr_t number = 0;
+	if (stored.symb != NULL)
+	{
+	    number = stored.symb - symtab->symbols + 1;
+	    ok = number <= header.symbol_count; //not from this table
+	}
+	stored.symb = (symbol_t*)number;
+	fwrite(&stored,sizeof(stored),1,fp);
+    }
+
+    if (symtab != NULL)
+	fwrite(symtab->strings,1,symtab->strings_length,fp);
+
+    ok = !ferror(fp) && ok;
+    if (fclose(fp) != 0 || !ok || rename(temp,cache->path) != 0)
+    {
+	unlink(temp);
+	return;
+    }
+    evict(cache);
+}
+
+/* ************************************************************************* *
+ * Purpose: Report how this run used the cache and the directory's totals    *
+ *          (-t).  Goes to stderr like the interpreter statistics.           *
+ * ************************************************************************* */
+void result_cache_print_stats(result_cache_t* cache)
+{
+    cache_stats_t stats;
+    if (cache->dir == NULL)
+	return;
+    read_stats(cache->dir,&stats);
+    uint64_t lookups = stats.hits + stats.misses;
+    fprintf(stderr,"Disassembly cache           %s\n",
+	    cache->hit ? "hit" : "miss");
+    if (cache->hit)
+	fprintf(stderr,"Time saved                  %.6f s\n",
+		cache->seconds_saved);
+    fprintf(stderr,"Cache hits, all runs        %" PRIu64 "\n",stats.hits);
+    fprintf(stderr,"Cache misses, all runs      %" PRIu64 "\n",stats.misses);
+    if (lookups > 0)
+	fprintf(stderr,"Cache hit rate              %.1f%%\n",
+		100.0 * stats.hits / lookups);
+    fprintf(stderr,"Time saved, all runs        %.6f s\n",
+	    stats.seconds_saved);
+}
+
+/* ************************************************************************* *
+ * Purpose: Free what result_cache_open read                                 *
+ * ************************************************************************* */
+void result_cache_close(result_cache_t* cache)
+{
+    free(cache->symlist);
+    cache->symlist = NULL;
+}
@@ -0,0 +1,39 @@
+#ifndef __DISASM_RESULT_CACHE__
+#define __DISASM_RESULT_CACHE__
+
+#include <stdio.h>		/* FILENAME_MAX */
+#include "disasm.h"		/* inst_list_t, symtab_t */
+
+/* Entries are removed, least recently used first, once the directory holds
+ * more than this many bytes of them or more than this many entries */
+#define RESULT_CACHE_MAX_BYTES (64 << 20)
+#define RESULT_CACHE_MAX_ENTRIES 1024
+
+/* One run's use of the cache directory (-C).  The key is a hash of
+ * everything the disassembly depends on: the image, the bytes of the
+ * symlist file (not its name), the origin, and whether -r made the
+ * symbols up. */
+typedef struct result_cache {
+    const char* dir; //the cache directory
+    char path[FILENAME_MAX]; //the entry for this image and symlist
+    uint8_t* image; //the image, compared in full on a hit
+    int image_length;
+    uint8_t* symlist; //the symlist file's bytes, NULL if there is none
+    size_t symlist_length;
+    uint32_t mode; //RESULT_CACHE_* bits, see result-cache.c
+    uint16_t origin;
+    _Bool hit; //this run's result came from the cache
+    double seconds_saved; //decode time the hit saved, less the load time
+} result_cache_t;
+
+/*Prototypes*/
+int result_cache_open(result_cache_t*,const char*,uint8_t*,int,uint16_t,
+		      const char*,_Bool);
+_Bool result_cache_load(result_cache_t*,symtab_t**,symtab_index_t**,
+			inst_list_t*);
+void result_cache_store(result_cache_t*,symtab_t*,const symtab_index_t*,
+			inst_list_t*,double);
+void result_cache_print_stats(result_cache_t*);
+void result_cache_close(result_cache_t*);
+
+#endif
@@ -0,0 +1,128 @@
+/* ************************************************************************* *
+ * stream.c                                                                  *
+ * --------                                                                  *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Streaming disassembler (-p).  Bytes are decoded and listed as  *
+ *            they are read, from a file or from standard input, keeping     *
+ *            only a fixed window of the stream in memory.  A stream can be  *
+ *            any length: a pipe, a memory capture, or many images one       *
+ *            after another.                                                 *
+ *                                                                           *
+ *            Every byte is decoded as an instruction, as it is without -s;  *
+ *            for an image that decodes cleanly and has a STOP, the listing  *
+ *            is the same one print_disassembler gives, except that the      *
+ *            address column keeps counting past 0xFFFF.  Two cases differ,  *
+ *            because the listing is written before the rest of the stream   *
+ *            is seen:                                                       *
+ *              - an instruction that does not decode prints its error after *
+ *                the lines already listed, where the normal listing prints  *
+ *                only the error (fig_5_7.pep8 without -s, for one);         *
+ *              - an image without a STOP is listed and exits 0, where the   *
+ *                normal listing refuses it and exits 1.                     *
+ * ************************************************************************* */
+
+
+/* ************************************************************************* *
+ * Library includes here.                                                    *
+ * ************************************************************************* */
+
+#include <stdio.h>              /* standard I/O */
+#include <stdint.h>             /* uint8_t, uint64_t */
+#include <stdbool.h>		/* bool types */
+#include <string.h>		/* memmove, strcmp */
+#include <errno.h>		/* EINTR */
+#include <fcntl.h>		/* open */
+#include <unistd.h>		/* read, close */
+
+#include "stream.h"			/* header file */
+#include "disasm.h"			/* decode_instruction */
+#include "../output/print-disasm.h"	/* print_line */
+
+/* ************************************************************************* *
+ * Global variable declarations                                              *
+ * ************************************************************************* */
+#define STREAM_WINDOW (1 << 16) //bytes of the stream held at once
+
+/* ************************************************************************* *
+ * disassemble_stream -- lists a file or standard input as it is read        *
+ *                                                                           *
+ * Parameters                                                                *
+ *   filename -- the file to read, or "-" for standard input                 *
+ *   origin -- the address of the first byte                                 *
+ *                                                                           *
+ * Returns                                                                   *
+ *    0 - if success                                                         *
+ *    1 - if failure                                                         *
+ *                                                                           *
+ * Notes                                                                     *
+ *   An instruction is decoded once its three bytes are in the window, or    *
+ *   at the end of the stream.  What has been listed is written out after    *
+ *   every read, so lines appear as the bytes arrive on a pipe.  An          *
+ *   instruction cut off by the end of the stream is reported the way the    *
+ *   whole-file disassembler reports it, after the lines before it.          *
+ * ************************************************************************* */
+int disassemble_stream(const char* filename,uint16_t origin)
+{
+    static uint8_t window[STREAM_WINDOW];
+    int fd = 0; //standard input
+    if (strcmp(filename,"-") != 0)
+    {
+	fd = open(filename,O_RDONLY);
+	if (fd < 0)
+	{
+	    printf("File \"%s\" does not exist\n",filename);
+	    return 1;
+	}
+    }
+
+    uint64_t base = origin; //the address of window[0]
+    int have = 0; //bytes in the window
+    int index = 0; //the next byte to decode
+    bool eof = false;
+    instruction_t inst;
+    decode_status_t status = DECODE_OK;
+
+    print_first_line();
+    while (!eof && status == DECODE_OK)
+    {
+	ssize_t got = read(fd,window + have,STREAM_WINDOW - have);
+	if (got < 0 && errno == EINTR)
+	    continue;
+	if (got < 0)
+	{
+	    perror(filename);
+	    break;
+	}
+	eof = got == 0;
+	have += got;
+
+	//decode every instruction whose bytes are all here
+	while (index < have && (eof || index + 3 <= have))
+	{
+	    int next = 0;
+	    status = decode_instruction(window,have,NULL,index,&inst,&next);
+	    if (status != DECODE_OK)
+		break;
+	    print_offset(base + index);
+	    print_line(&inst,window,NULL);
+	    index = next;
+	}
+
+	//keep only the bytes not decoded yet
+	memmove(window,window + index,have - index);
+	base += index;
+	have -= index;
+	index = 0;
+	print_listing_flush();
+	fflush(stdout);
+    }
+
+    if (fd != 0)
+	close(fd);
+    if (status != DECODE_OK)
+	report_decode_error(status,window[index]); //exits
+    if (!eof)
+	return 1;
+    print_last_line();
+    return 0;
+}
@@ -0,0 +1,9 @@
+#ifndef __DISASM_STREAM__
+#define __DISASM_STREAM__
+
+#include <stdint.h>		/* uint16_t */
+
+/*Prototypes*/
+int disassemble_stream(const char*,uint16_t);
+
+#endif
@@ -0,0 +1,191 @@
+/* ************************************************************************* *
+ * xref.c                                                                    *
+ * ------                                                                    *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Cross-reference index (-x).  Every branch and call target,     *
+ *            every memory operand and every immediate operand that names a  *
+ *            symbol is indexed by the address it refers to, so who refers   *
+ *            to an address is one lookup.  The index is made from the       *
+ *            decoded instruction list, which is the same whether it was     *
+ *            decoded serially, on threads, or read from the cache.          *
+ *                                                                           *
+ *            Stack-relative operands are offsets from SP, not addresses,    *
+ *            and are left out.                                              *
+ * ************************************************************************* */
+
+
+/* ************************************************************************* *
+ * Library includes here.                                                    *
+ * ************************************************************************* */
+
+#include <stdio.h>              /* standard I/O */
+#include <stdint.h>             /* uint8_t, uint32_t */
+#include <stdlib.h>		/* malloc, strtoul */
+#include <string.h>		/* strcmp */
+
+#include "xref.h"		/* header file */
+#include "../main/pep8.h"	/* mnemonic_t */
+
+/* ************************************************************************* *
+ * Global variable declarations                                              *
+ * ************************************************************************* */
+const char *XREF_KINDS[] = {
+    "branch", "call", "read", "write", "address"
+};
+
+/* ************************************************************************* *
+ * Purpose: Tell how a line refers to its operand's address                  *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      inst: the line                                                       *
+ *      symbols: the symbol table by address, or NULL if there is none       *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      int: an xref_kind_t, or -1 if the line refers to no address          *
+ * ************************************************************************* */
+int xref_kind_of(instruction_t* inst,const symtab_index_t* symbols)
+{
+    symbol_t* symbol = NULL;
+    if (inst->unary || inst->addr_mode == DNE ||
+	(inst->symb != NULL && inst->symb->type != LINE)) //a directive
+	return -1;
+
+    if (inst->mnem >= BR && inst->mnem <= CALL)
+    {
+	if (inst->addr_mode == 0x01) //,x: a jump table
+	    return XREF_READ;
+	return inst->mnem == CALL ? XREF_CALL : XREF_BRANCH;
+    }
+
+    switch (inst->addr_mode)
+    {
+    case 0x00: //i
+	symbol = symtab_lookup(symbols,inst->op_spec);
+	if (symbol != NULL && symbol->label != 0)
+	    return XREF_ADDRESS;
+	return -1;
+    case 0x01: //d
+    case 0x05: //x
+	if (inst->mnem == DECI || inst->mnem == CHARI ||
+	    (inst->mnem >= STA && inst->mnem <= STBYTEX))
+	    return XREF_WRITE;
+	return XREF_READ;
+    case 0x02: //n: the pointer is read, whatever is done where it points
+	return XREF_READ;
+    default: //s, sf, sx, sxf
+	return -1;
+    }
+}
+
+/* ************************************************************************* *
+ * xref_build -- indexes the references in a disassembly                     *
+ *                                                                           *
+ * Parameters                                                                *
+ *   instructions -- the instruction list                                    *
+ *   symbols -- the symbol table by address, or NULL if there is none        *
+ *                                                                           *
+ * Returns                                                                   *
+ *   the index (free it with xref_free), or NULL if out of memory            *
+ *                                                                           *
+ * Notes                                                                     *
+ *   The list is walked twice, once to count the references to each          *
+ *   address and once to put them in place, so the index is three flat       *
+ *   arrays with no per-reference allocation.                                *
+ * ************************************************************************* */
+xref_t* xref_build(inst_list_t* instructions,const symtab_index_t* symbols)
+{
+    xref_t* xref = calloc(1,sizeof(xref_t));
+    uint32_t* next = calloc(SYMTAB_INDEX_SIZE,sizeof(uint32_t));
+    size_t i = 0;
+    uint32_t address = 0;
+    if (xref == NULL || next == NULL)
+    {
+	free(xref);
+	free(next);
+	return NULL;
+    }
+
+    //count; first[a + 1] holds the count for a until the sums below
+    for (i = 0; i < instructions->count; i++)
+    {
+	if (xref_kind_of(&instructions->items[i],symbols) >= 0)
+	{
+	    xref->first[instructions->items[i].op_spec + 1]++;
+	    xref->count++;
+	}
+    }
+    for (address = 0; address < SYMTAB_INDEX_SIZE; address++)
+    {
+	xref->first[address + 1] += xref->first[address];
+	next[address] = xref->first[address];
+    }
+
+    xref->line = malloc((xref->count + 1) * sizeof(uint32_t));
+    xref->kind = malloc(xref->count + 1);
+    if (xref->line == NULL || xref->kind == NULL)
+    {
+	free(next);
+	xref_free(xref);
+	return NULL;
+    }
+    for (i = 0; i < instructions->count; i++)
+    {
+	int kind = xref_kind_of(&instructions->items[i],symbols);
+	if (kind >= 0)
+	{
+	    uint32_t at = next[instructions->items[i].op_spec]++;
+	    xref->line[at] = i;
+	    xref->kind[at] = kind;
+	}
+    }
+    free(next);
+    return xref;
+}
+
+/* ************************************************************************* *
+ * Purpose: Free an index from xref_build                                    *
+ * ************************************************************************* */
+void xref_free(xref_t* xref)
+{
+    if (xref == NULL)
+	return;
+    free(xref->line);
+    free(xref->kind);
+    free(xref);
+}
+
+/* ************************************************************************* *
+ * xref_find_target -- turns what was given to -x into an address            *
+ *                                                                           *
+ * Parameters                                                                *
+ *   name -- a label, or an address such as 0x0011 or 17                     *
+ *   symtab -- the symbol table, NULL if there is none                       *
+ *   address -- receives the address                                         *
+ *                                                                           *
+ * Returns                                                                   *
+ *    0 - if success                                                         *
+ *    1 - if name is neither an address nor a label                          *
+ *                                                                           *
+ * Notes                                                                     *
+ *    A label is looked for first, so a label that looks like a number       *
+ *    still names its symbol.                                                *
+ * ************************************************************************* */
+int xref_find_target(const char* name,symtab_t* symtab,uint16_t* address)
+{
+    uint32_t i = 0;
+    char* end = NULL;
+    for (i = 0; symtab != NULL && i < symtab->count; i++)
+    {
+	const char* label = symbol_label(symtab,&symtab->symbols[i]);
+	if (label != NULL && strcmp(label,name) == 0)
+	{
+	    *address = symtab->symbols[i].offset;
+	    return 0;
+	}
+    }
+    unsigned long value = strtoul(name,&end,0);
+    if (*name == '\0' || *end != '\0' || value >= SYMTAB_INDEX_SIZE)
+	return 1;
+    *address = value;
+    return 0;
+}
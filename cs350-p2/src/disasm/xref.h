@@ -0,0 +1,37 @@
+#ifndef __DISASM_XREF__
+#define __DISASM_XREF__
+
+#include "disasm.h"		/* inst_list_t, symtab_index_t */
+
+/* How a line refers to the address its operand names */
+typedef enum xref_kind {
+    XREF_BRANCH, //BR and the conditional branches, immediate target
+    XREF_CALL, //CALL, immediate target
+    XREF_READ, //read there: direct, indexed (the base), or the pointer of
+	       //an indirect operand; also an indexed branch's jump table
+    XREF_WRITE, //written there directly or indexed: STr, STBYTEr, DECI, CHARI
+    XREF_ADDRESS //an immediate operand that names a symbol
+} xref_kind_t;
+
+#define NUMBER_OF_XREF_KINDS (XREF_ADDRESS + 1)
+
+/* Every reference in a disassembly, by the address referred to.  The
+ * references to address a are line[first[a]] .. line[first[a + 1] - 1],
+ * in address order; line holds indexes into the instruction list. */
+typedef struct xref {
+    uint32_t first[SYMTAB_INDEX_SIZE + 1];
+    uint32_t* line;
+    uint8_t* kind; //an xref_kind_t for each entry of line
+    uint32_t count;
+} xref_t;
+
+/* Global constants defined in xref.c */
+extern const char *XREF_KINDS[];
+
+/*Prototypes*/
+int xref_kind_of(instruction_t*,const symtab_index_t*);
+xref_t* xref_build(inst_list_t*,const symtab_index_t*);
+void xref_free(xref_t*);
+int xref_find_target(const char*,symtab_t*,uint16_t*);
+
+#endif
@@ -12,6 +12,7 @@
  *   http://pubs.opengroup.org/onlinepubs/009695399/functions/contents.html  *
  * ************************************************************************* */
 
+#define _GNU_SOURCE                     /* memfd_create */
 #include <stdbool.h>                    /* bool types */
 #include <stdint.h>                     /* uint32_t, uint8_t, etc. */
 #include <stdlib.h>                     /* malloc */
@@ -20,6 +21,22 @@
 #include "bus.h"			/* header file */
 #include "interp.h"			/* cpu_t */
 #include "processor.h"			/* instructions */
+#include "cache.h"			/* cache_invalidate */
+
+/* ************************************************************************* *
+ * The mirrored mapping needs memfd_create (Linux).  Everywhere else the     *
+ * address space is an ordinary buffer with two spare bytes after it, which  *
+ * read as zero when an access wraps past 0xFFFF.                            *
+ * ************************************************************************* */
+#if defined(__linux__)
+#define MIRRORED_SPACE
+#include <sys/mman.h>			/* mmap, memfd_create */
+#include <unistd.h>			/* ftruncate, close */
+
+#define GUARD_SIZE 4096 //one page past the mirror, left inaccessible
+
+static _Bool mirrored = false; //how the last space was made
+#endif
 /* ************************************************************************* *
  * Local function declarations                                               *
  * ************************************************************************* */
@@ -48,3 +65,81 @@ uint32_t fetch(uint8_t *memory, uint16_t starting_address)
     next_3_bytes += (least_sig);
     return next_3_bytes;     
 }
+
+/* ************************************************************************* *
+ * Purpose: write one byte of memory                                         *
+ *									     *
+ * Parameters: 								     *
+ * 	memory:  the bytes to interpret the instructions		     *
+ *	address: the byte to write					     *
+ *	value: the new contents of the byte				     *
+ *									     *
+ * Notes:								     *
+ *	Every guest store goes through here so that anything decoded from    *
+ *	the old bytes can be thrown away.				     *
+ * ************************************************************************* */
+void store_byte(uint8_t *memory, uint16_t address, uint8_t value)
+{
+    memory[address] = value;
+    cache_invalidate(address);
+}
+
+/* ************************************************************************* *
+ * Purpose: Make a zeroed 64 KB Pep/8 address space                          *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      uint8_t*: the space, or NULL if it could not be made                 *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      One memfd is mapped at base and again at base + 64 KB, so the byte   *
+ *      after 0xFFFF is byte 0 and the helpers never have to mask or test an *
+ *      address.  The page after the second copy stays PROT_NONE: anything   *
+ *      that indexes further than a 16-bit address plus two faults instead   *
+ *      of reading the heap.                                                 *
+ * ************************************************************************* */
+uint8_t* address_space_create()
+{
+#ifdef MIRRORED_SPACE
+    size_t size = 2 * ADDRESS_SPACE_SIZE + GUARD_SIZE;
+    int fd = memfd_create("pep8",0);
+    if (fd >= 0 && ftruncate(fd,ADDRESS_SPACE_SIZE) == 0)
+    {
+	uint8_t* base = mmap(NULL,size,PROT_NONE,MAP_PRIVATE | MAP_ANONYMOUS,
+			     -1,0);
+	if (base != MAP_FAILED &&
+	    mmap(base,ADDRESS_SPACE_SIZE,PROT_READ | PROT_WRITE,
+		 MAP_SHARED | MAP_FIXED,fd,0) != MAP_FAILED &&
+	    mmap(base + ADDRESS_SPACE_SIZE,ADDRESS_SPACE_SIZE,
+		 PROT_READ | PROT_WRITE,MAP_SHARED | MAP_FIXED,fd,0)
+	    != MAP_FAILED)
+	{
+	    close(fd);
+	    mirrored = true;
+	    return base;
+	}
+	if (base != MAP_FAILED)
+	    munmap(base,size);
+    }
+    if (fd >= 0)
+	close(fd);
+    mirrored = false;
+#endif
+    return calloc(ADDRESS_SPACE_SIZE + 2,sizeof(uint8_t));
+}
+
+/* ************************************************************************* *
+ * Purpose: Release a space from address_space_create                        *
+ * ************************************************************************* */
+void address_space_free(uint8_t* memory)
+{
+    if (memory == NULL)
+	return;
+#ifdef MIRRORED_SPACE
+    if (mirrored)
+    {
+	munmap(memory,2 * ADDRESS_SPACE_SIZE + GUARD_SIZE);
+	return;
+    }
+#endif
+    free(memory);
+}
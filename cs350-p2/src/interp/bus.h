@@ -5,6 +5,14 @@
  * invalid mnemonics.
  */
 
+/* The Pep/8 address space.  address_space_create maps it twice in a row with
+ * a guard page after the second copy, so memory[address + 1] and
+ * memory[pc + 2] read the wrapped-around bytes for any 16-bit address. */
+#define ADDRESS_SPACE_SIZE 0x10000
+
 /*Prototypes*/
 uint32_t fetch(uint8_t*,uint16_t);
+void store_byte(uint8_t*,uint16_t,uint8_t);
+uint8_t* address_space_create();
+void address_space_free(uint8_t*);
 #endif
@@ -0,0 +1,159 @@
+/* ************************************************************************* *
+ * cache.c                                                                   *
+ * ------                                                                    *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Decoded-instruction cache used by interp.c.  Every guest       *
+ *            address gets a slot that is filled the first time the PC       *
+ *            reaches it and dropped when a store hits its bytes.  When the  *
+ *            program has been disassembled, its instructions are put in     *
+ *            their slots before the run starts.                             *
+ * ************************************************************************* */
+
+
+/* ************************************************************************* *
+ * Library includes here.  For documentation of standard C library           *
+ * functions, see the list at:                                               *
+ *   http://pubs.opengroup.org/onlinepubs/009695399/functions/contents.html  *
+ * ************************************************************************* */
+
+#include <stdbool.h>                    /* bool types */
+#include <stdint.h>                     /* uint32_t, uint8_t, etc. */
+#include <stddef.h>                     /* size_t */
+#include <string.h>                     /* memset */
+
+#include "cache.h"			/* header file */
+#include "bus.h"			/* fetch */
+#include "processor.h"			/* decode */
+
+/* ************************************************************************* *
+ * Global variable declarations                                              *
+ * ************************************************************************* */
+cache_entry_t cache_entries[CACHE_SLOTS] __attribute__((aligned(64)));
+uint8_t cache_valid[CACHE_SLOTS]; //kept apart so a reset is a 64 KB memset
+uint64_t cache_hits;
+static uint64_t misses;
+static uint64_t invalidations;
+static const inst_list_t* program; //see cache_set_program
+static uint16_t program_origin;
+
+/* ************************************************************************* *
+ * Purpose: Give every run the disassembled program's instructions up front  *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      instructions: the listing, from determine_instructions; it must      *
+ *                    stay until the last run.  NULL goes back to an empty   *
+ *                    cache                                                  *
+ *      origin: where the program was loaded                                 *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      The listing and the interpreter decode through the same              *
+ *      decode_specifier, so its records need nothing but the guest address  *
+ *      to be what cache_fill would have made.  Directives are left out.     *
+ * ************************************************************************* */
+void cache_set_program(const inst_list_t* instructions,uint16_t origin)
+{
+    program = instructions;
+    program_origin = origin;
+}
+
+/* ************************************************************************* *
+ * Purpose: Empty the cache and zero its counters before a new run, then put *
+ *          in the program set by cache_set_program                          *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      memory: the bytes about to be interpreted                            *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      size_t: how many slots were filled from the program                  *
+ * ************************************************************************* */
+size_t cache_reset(uint8_t* memory)
+{
+    size_t filled = 0;
+    size_t i = 0;
+    memset(cache_valid,0,sizeof(cache_valid));
+    cache_hits = 0;
+    misses = 0;
+    invalidations = 0;
+
+    for (i = 0; program != NULL && i < program->count; i++)
+    {
+	const instruction_t* inst = &program->items[i];
+	uint16_t pc = program_origin + inst->addr;
+	if (inst->mnem >= ASCII_mnem) //a directive, not an instruction
+	    continue;
+	cache_entries[pc].inst = *inst;
+	cache_entries[pc].inst.addr = pc;
+	cache_entries[pc].inst.symb = NULL;
+	cache_entries[pc].inst.inst_reg = fetch(memory,pc);
+	cache_entries[pc].handler = NULL;
+	cache_valid[pc] = true;
+	filled++;
+    }
+    return filled;
+}
+
+/* ************************************************************************* *
+ * Purpose: The miss path of cache_lookup (see cache.h): fetch and decode    *
+ *          the instruction at the pep8 program counter into its slot        *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      memory: the bytes to interpret                                       *
+ *      pep8: the cpu whose pc is looked up; its inst_reg is loaded          *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      cache_entry_t: the slot, now valid                                   *
+ * ************************************************************************* */
+cache_entry_t* cache_fill(uint8_t* memory,cpu_t* pep8)
+{
+    uint16_t pc = pep8->pc;
+    cache_entry_t* entry = &cache_entries[pc];
+
+    misses++;
+    pep8->inst_reg = fetch(memory,pc);
+    decode(pep8,&entry->inst);
+    entry->inst.inst_reg = pep8->inst_reg;
+    entry->handler = NULL;
+    cache_valid[pc] = true;
+    return entry;
+}
+
+/* ************************************************************************* *
+ * Purpose: Drop every slot whose fetched bytes include address              *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      address: the byte a store just wrote                                 *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      fetch always reads 3 bytes (even for unary instructions, whose IR    *
+ *      shows the two bytes after them), so the slots at address, address-1 *
+ *      and address-2 all depend on the byte.                                *
+ * ************************************************************************* */
+void cache_invalidate(uint16_t address)
+{
+    int i = 0;
+    for (i = 0; i < 3; i++)
+    {
+	uint16_t slot = address - i;
+	if (cache_valid[slot])
+	{
+	    cache_valid[slot] = false;
+	    invalidations++;
+	}
+    }
+}
+
+/* ************************************************************************* *
+ * Purpose: Report the cache counters since the last cache_reset             *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      hit_count: lookups answered from the cache                           *
+ *      miss_count: lookups that had to fetch and decode                     *
+ *      invalidation_count: slots dropped because a store hit them           *
+ * ************************************************************************* */
+void cache_counters(uint64_t* hit_count,uint64_t* miss_count,
+		    uint64_t* invalidation_count)
+{
+    *hit_count = cache_hits;
+    *miss_count = misses;
+    *invalidation_count = invalidations;
+}
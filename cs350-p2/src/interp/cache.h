@@ -0,0 +1,63 @@
+#ifndef __CACHE__
+#define __CACHE__
+
+#include "processor.h"		/* instruction_t */
+#include "interp.h"		/* cpu_t */
+#include "../disasm/disasm.h"	/* inst_list_t */
+
+/* Size of the Pep/8 address space; the cache has one slot per address */
+#define CACHE_SLOTS 0x10000
+
+/* One decoded instruction, keyed by the address it was fetched from.  The
+ * fetched bytes ride in inst.inst_reg, so an entry is 32 bytes; cache.c
+ * aligns the array to 64, so no entry straddles a cache line. */
+typedef struct cache_entry {
+    instruction_t inst; //decoded instruction, inst_reg replayed on a hit
+    const void* handler; //threaded-code target (dispatch.c), NULL until set
+} cache_entry_t;
+
+_Static_assert(sizeof(cache_entry_t) == 32,"two cache entries per line");
+
+/* Storage, defined in cache.c.  Only the inline hit path below reads it
+ * directly; everything else goes through the functions. */
+extern cache_entry_t cache_entries[CACHE_SLOTS];
+extern uint8_t cache_valid[CACHE_SLOTS];
+extern uint64_t cache_hits;
+
+/*Prototypes*/
+void cache_set_program(const inst_list_t*,uint16_t);
+size_t cache_reset(uint8_t*);
+cache_entry_t* cache_fill(uint8_t*,cpu_t*);
+void cache_invalidate(uint16_t);
+void cache_counters(uint64_t*,uint64_t*,uint64_t*);
+
+/* ************************************************************************* *
+ * Purpose: Fetch and decode the instruction at the pep8 program counter,    *
+ *          reusing the cached decode when there is one                      *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      memory: the bytes to interpret                                       *
+ *      pep8: the cpu whose pc is looked up; its inst_reg is loaded          *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      cache_entry_t: the slot holding the decoded instruction.  It stays   *
+ *                     readable until the next lookup even if a store        *
+ *                     invalidates it                                        *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      Inline because the engines call it once per step; only a miss       *
+ *      leaves the caller (cache_fill).                                      *
+ * ************************************************************************* */
+static inline cache_entry_t* cache_lookup(uint8_t* memory,cpu_t* pep8)
+{
+    uint16_t pc = pep8->pc;
+    if (cache_valid[pc])
+    {
+	cache_hits++;
+	pep8->inst_reg = cache_entries[pc].inst.inst_reg;
+	return &cache_entries[pc];
+    }
+    return cache_fill(memory,pep8);
+}
+
+#endif
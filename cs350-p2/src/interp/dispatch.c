@@ -0,0 +1,432 @@
+/* ************************************************************************* *
+ * dispatch.c                                                                *
+ * ------                                                                    *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Threaded-code execution engine (-e threaded).  Each cached     *
+ *            instruction remembers the body that executes it, and every     *
+ *            body ends by fetching and jumping straight to the next one,    *
+ *            so there is no central loop and no call through OPCODES for    *
+ *            the instructions that have a body of their own.                *
+ * ************************************************************************* */
+
+
+/* ************************************************************************* *
+ * Library includes here.  For documentation of standard C library           *
+ * functions, see the list at:                                               *
+ *   http://pubs.opengroup.org/onlinepubs/009695399/functions/contents.html  *
+ * ************************************************************************* */
+
+#include <stdbool.h>                    /* bool types */
+#include <stdint.h>                     /* uint32_t, uint8_t, etc. */
+#include <stdio.h>			/* printf */
+
+#include "interp.h"			/* cpu_t */
+#include "processor.h"			/* increment, OPCODES */
+#include "proc-helper.h"		/* execute_stop */
+#include "cache.h"			/* decoded-instruction cache */
+#include "flags.h"			/* condition codes */
+#include "../output/print-interp.h"	/* output interpreter */
+#include "../output/trace.h"		/* binary trace */
+#include "../main/pep8.h"		/* mnemonics */
+
+/* ************************************************************************* *
+ * The engine is chosen at build time.  GCC and clang support labels as      *
+ * values, which lets each body jump directly to the next instruction's body *
+ * ("goto *handler").  Any other compiler, or a build with                   *
+ *      make CPPFLAGS=-DSWITCH_DISPATCH                                      *
+ * gets a portable loop around a switch over the same bodies.                *
+ * ************************************************************************* */
+#if defined(__GNUC__) && !defined(SWITCH_DISPATCH)
+#define THREADED_DISPATCH
+#endif
+
+/* The bodies the engine has.  Anything without its own body is run through
+ * its OPCODES handler, which also covers the unsupported instructions and
+ * the addressing modes the inline bodies do not handle. */
+typedef enum body {
+    BODY_CALL, BODY_STOP, BODY_BR, BODY_BRLE, BODY_BRLT, BODY_BREQ,
+    BODY_BRNE, BODY_BRGE, BODY_BRGT, BODY_CP, BODY_ADD_I, BODY_SUB_I,
+    BODY_AND_I, BODY_OR_I, BODY_LD_I, BODY_ADD_D, BODY_SUB_D,
+    BODY_AND_D, BODY_OR_D, BODY_LD_D
+} body_t;
+
+#define NUMBER_OF_BODIES (BODY_LD_D + 1)
+
+//bodies that do not depend on the addressing mode
+static const uint8_t BODY_OF[NUMBER_OF_MNEMONICS] = {
+    [STOP] = BODY_STOP, [BR] = BODY_BR, [BRLE] = BODY_BRLE,
+    [BRLT] = BODY_BRLT, [BREQ] = BODY_BREQ, [BRNE] = BODY_BRNE,
+    [BRGE] = BODY_BRGE, [BRGT] = BODY_BRGT,
+    [CPA] = BODY_CP, [CPX] = BODY_CP //execute_cpr always uses op_spec
+};
+
+//bodies for the immediate addressing mode only
+static const uint8_t IMMEDIATE_BODY_OF[NUMBER_OF_MNEMONICS] = {
+    [ADDA] = BODY_ADD_I, [ADDX] = BODY_ADD_I,
+    [SUBA] = BODY_SUB_I, [SUBX] = BODY_SUB_I,
+    [ANDA] = BODY_AND_I, [ANDX] = BODY_AND_I,
+    [ORA] = BODY_OR_I, [ORX] = BODY_OR_I,
+    [LDA] = BODY_LD_I, [LDX] = BODY_LD_I
+};
+
+//bodies for the direct addressing mode only
+static const uint8_t DIRECT_BODY_OF[NUMBER_OF_MNEMONICS] = {
+    [ADDA] = BODY_ADD_D, [ADDX] = BODY_ADD_D,
+    [SUBA] = BODY_SUB_D, [SUBX] = BODY_SUB_D,
+    [ANDA] = BODY_AND_D, [ANDX] = BODY_AND_D,
+    [ORA] = BODY_OR_D, //execute_orr gives ORX op_spec in every mode
+    [LDA] = BODY_LD_D, [LDX] = BODY_LD_D
+};
+
+/* ************************************************************************* *
+ * Purpose: Pick the body that executes a decoded instruction                *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      inst: the decoded instruction                                        *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      body_t: the body; BODY_CALL when the OPCODES handler must run it     *
+ * ************************************************************************* */
+static body_t select_body(instruction_t* inst)
+{
+    if (inst->addr_mode == 0 && IMMEDIATE_BODY_OF[inst->mnem] != BODY_CALL)
+	return IMMEDIATE_BODY_OF[inst->mnem];
+    if (inst->addr_mode == 1 && DIRECT_BODY_OF[inst->mnem] != BODY_CALL)
+	return DIRECT_BODY_OF[inst->mnem];
+    return BODY_OF[inst->mnem];
+}
+
+/* ************************************************************************* *
+ * The program counter is a local the compiler keeps in a machine register   *
+ * across the jumps, and is written back before anything that looks at the   *
+ * cpu object (a cache miss, an OPCODES handler, the trace, the end of the   *
+ * run).  The accumulator, index register and the N/Z result stay in the     *
+ * cpu object, as they do for the handlers: copying them out and back around *
+ * every handler call cost more than the bodies saved.  A pending V/C lives  *
+ * only in the cpu object too (see flags.h).                                 *
+ * ************************************************************************* */
+#define SAVE_PC() (pep8->pc = pc)
+#define LOAD_PC() (pc = pep8->pc)
+
+//fetch (through the cache), decode and increment
+#define STEP()								\
+    do {								\
+	SAVE_PC();							\
+	entry = cache_lookup(memory,pep8);				\
+	inst = &entry->inst;						\
+	pc += inst->unary ? 1 : 3; /* increment */			\
+	if (tracing)							\
+	    trace_step(pep8,pc,trace,steps);				\
+	steps++;							\
+    } while (0)
+
+//an OPCODES handler needs the real cpu object
+#define CALL_HANDLER()							\
+    do {								\
+	SAVE_PC();							\
+	OPCODES[inst->inst_spec].execute(pep8,inst,memory);		\
+	LOAD_PC();							\
+    } while (0)
+
+//the flags.h recording and reading, written out so -O0 makes no calls
+#define SET_NZ(value) (pep8->nz_result = (value))
+#define N (((pep8->nz_result >> 15) & 1) == 1)
+#define Z (pep8->nz_result == 0)
+
+//the word a direct-mode operand names, read as the OPCODES handlers read it
+#define DIRECT_OPERAND							\
+    ((uint16_t)((memory[inst->op_spec] << 8) + memory[inst->op_spec + 1]))
+
+//the bodies for ANDr, ORr and LDr, on the accumulator or the index register
+#define ALU(op,operand)							\
+    do {								\
+	if (inst->registr == 0)						\
+	{								\
+	    pep8->accum op (operand);					\
+	    SET_NZ(pep8->accum);					\
+	}								\
+	else								\
+	{								\
+	    pep8->x op (operand);					\
+	    SET_NZ(pep8->x);						\
+	}								\
+    } while (0)
+
+//ADDr and SUBr also leave V and C pending on the operands
+#define SET_VC(op,left,right)						\
+    do {								\
+	pep8->vc_op = (op);						\
+	pep8->vc_left = (left);						\
+	pep8->vc_right = (right);					\
+    } while (0)
+
+#define ARITH(op,vc,operand)						\
+    do {								\
+	uint16_t right = (operand);					\
+	if (inst->registr == 0)						\
+	{								\
+	    SET_VC(vc,pep8->accum,right);				\
+	    pep8->accum op right;					\
+	    SET_NZ(pep8->accum);					\
+	}								\
+	else								\
+	{								\
+	    SET_VC(vc,pep8->x,right);					\
+	    pep8->x op right;						\
+	    SET_NZ(pep8->x);						\
+	}								\
+    } while (0)
+
+//execute_cpr: ignores the addressing mode and compares with op_spec
+#define COMPARE()							\
+    do {								\
+	uint16_t left = inst->registr == 0 ? pep8->accum : pep8->x;	\
+	SET_VC(VC_SUB,left,inst->op_spec);				\
+	SET_NZ(left - inst->op_spec);					\
+    } while (0)
+
+/* ************************************************************************* *
+ * Purpose: Print or record one step of a traced run                         *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      pep8: the cpu object used to run the program                         *
+ *      pc: the engine's program counter, already incremented                *
+ *      trace: TRACE_FULL or TRACE_BINARY                                    *
+ *      steps: the instructions run before this one                          *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      Kept out of line so an untraced run carries one test per step and    *
+ *      none of the trace code.                                              *
+ * ************************************************************************* */
+static void __attribute__((noinline)) trace_step(cpu_t* pep8,uint16_t pc,
+						  trace_t trace,
+						  uint64_t steps)
+{
+    SAVE_PC();
+    if (trace == TRACE_FULL)
+	print_interpreter(pep8);
+    else
+	trace_record_step(pep8,steps);
+}
+
+/* ************************************************************************* *
+ * Purpose: Run the program in memory with threaded dispatch                 *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      memory: the bytes to interpret                                       *
+ *      pep8: the cpu object used to run the program                         *
+ *      origin: the address to start at                                      *
+ *      trace: how much of the run to print                                  *
+ *      stats: receives the step and decode-cache counters                   *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      Produces exactly the same output as interpret_memory.  A cache miss  *
+ *      (first visit, or the bytes were stored to) clears the entry's        *
+ *      handler, so a patched instruction is given a fresh body.             *
+ * ************************************************************************* */
+void interpret_threaded(uint8_t* memory,cpu_t* pep8,uint16_t origin,
+			trace_t trace,interp_stats_t* stats)
+{
+    cache_entry_t* entry;
+    instruction_t* inst;
+    uint64_t steps = 0;
+    uint16_t pc;
+    const bool tracing = trace == TRACE_FULL || trace == TRACE_BINARY;
+    preset_cpu(pep8,origin);
+    pep8->trace = trace;
+    cache_reset(memory);
+    LOAD_PC();
+
+#ifdef THREADED_DISPATCH
+    static const void* const LABELS[NUMBER_OF_BODIES] = {
+	[BODY_CALL] = &&do_call, [BODY_STOP] = &&do_stop,
+	[BODY_BR] = &&do_br, [BODY_BRLE] = &&do_brle,
+	[BODY_BRLT] = &&do_brlt, [BODY_BREQ] = &&do_breq,
+	[BODY_BRNE] = &&do_brne, [BODY_BRGE] = &&do_brge,
+	[BODY_BRGT] = &&do_brgt, [BODY_CP] = &&do_cp,
+	[BODY_ADD_I] = &&do_add_i, [BODY_SUB_I] = &&do_sub_i,
+	[BODY_AND_I] = &&do_and_i, [BODY_OR_I] = &&do_or_i,
+	[BODY_LD_I] = &&do_ld_i, [BODY_ADD_D] = &&do_add_d,
+	[BODY_SUB_D] = &&do_sub_d, [BODY_AND_D] = &&do_and_d,
+	[BODY_OR_D] = &&do_or_d, [BODY_LD_D] = &&do_ld_d
+    };
+
+    //step, then jump to the body.  Every body ends with its own copy so each
+    //indirect jump is predicted on its own.
+#define DISPATCH()							\
+    do {								\
+	STEP();								\
+	if (entry->handler == NULL)					\
+	    entry->handler = LABELS[select_body(inst)];			\
+	goto *entry->handler;						\
+    } while (0)
+
+    DISPATCH();
+
+do_call:
+    CALL_HANDLER();
+    DISPATCH();
+do_stop:
+    SAVE_PC();
+    execute_stop(pep8,inst,memory);
+    goto done;
+do_br:
+    pc = inst->op_spec;
+    DISPATCH();
+do_brle:
+    if (N || Z)
+	pc = inst->op_spec;
+    DISPATCH();
+do_brlt:
+    if (N)
+	pc = inst->op_spec;
+    DISPATCH();
+do_breq:
+    if (Z)
+	pc = inst->op_spec;
+    DISPATCH();
+do_brne:
+    if (!Z)
+	pc = inst->op_spec;
+    DISPATCH();
+do_brge:
+    if (!N)
+	pc = inst->op_spec;
+    DISPATCH();
+do_brgt:
+    if (!N && !Z)
+	pc = inst->op_spec;
+    DISPATCH();
+do_cp:
+    COMPARE();
+    DISPATCH();
+do_add_i:
+    ARITH(+=,VC_ADD,inst->op_spec);
+    DISPATCH();
+do_sub_i:
+    ARITH(-=,VC_SUB,inst->op_spec);
+    DISPATCH();
+do_and_i:
+    ALU(&=,inst->op_spec);
+    DISPATCH();
+do_or_i:
+    ALU(|=,inst->op_spec);
+    DISPATCH();
+do_ld_i:
+    ALU(=,inst->op_spec);
+    DISPATCH();
+do_add_d:
+    ARITH(+=,VC_ADD,DIRECT_OPERAND);
+    DISPATCH();
+do_sub_d:
+    ARITH(-=,VC_SUB,DIRECT_OPERAND);
+    DISPATCH();
+do_and_d:
+    ALU(&=,DIRECT_OPERAND);
+    DISPATCH();
+do_or_d:
+    ALU(|=,DIRECT_OPERAND);
+    DISPATCH();
+do_ld_d:
+    ALU(=,DIRECT_OPERAND);
+    DISPATCH();
+
+#undef DISPATCH
+#else
+    for (;;)
+    {
+	STEP();
+	switch (select_body(inst))
+	{
+	case BODY_STOP:
+	    SAVE_PC();
+	    execute_stop(pep8,inst,memory);
+	    goto done;
+	case BODY_BR:
+	    pc = inst->op_spec;
+	    break;
+	case BODY_BRLE:
+	    if (N || Z)
+		pc = inst->op_spec;
+	    break;
+	case BODY_BRLT:
+	    if (N)
+		pc = inst->op_spec;
+	    break;
+	case BODY_BREQ:
+	    if (Z)
+		pc = inst->op_spec;
+	    break;
+	case BODY_BRNE:
+	    if (!Z)
+		pc = inst->op_spec;
+	    break;
+	case BODY_BRGE:
+	    if (!N)
+		pc = inst->op_spec;
+	    break;
+	case BODY_BRGT:
+	    if (!N && !Z)
+		pc = inst->op_spec;
+	    break;
+	case BODY_CP:
+	    COMPARE();
+	    break;
+	case BODY_ADD_I:
+	    ARITH(+=,VC_ADD,inst->op_spec);
+	    break;
+	case BODY_SUB_I:
+	    ARITH(-=,VC_SUB,inst->op_spec);
+	    break;
+	case BODY_AND_I:
+	    ALU(&=,inst->op_spec);
+	    break;
+	case BODY_OR_I:
+	    ALU(|=,inst->op_spec);
+	    break;
+	case BODY_LD_I:
+	    ALU(=,inst->op_spec);
+	    break;
+	case BODY_ADD_D:
+	    ARITH(+=,VC_ADD,DIRECT_OPERAND);
+	    break;
+	case BODY_SUB_D:
+	    ARITH(-=,VC_SUB,DIRECT_OPERAND);
+	    break;
+	case BODY_AND_D:
+	    ALU(&=,DIRECT_OPERAND);
+	    break;
+	case BODY_OR_D:
+	    ALU(|=,DIRECT_OPERAND);
+	    break;
+	case BODY_LD_D:
+	    ALU(=,DIRECT_OPERAND);
+	    break;
+	default:
+	    CALL_HANDLER();
+	    break;
+	}
+    }
+#endif
+
+done:
+    SAVE_PC();
+    print_end_of_run(pep8);
+
+    stats->steps = steps;
+    cache_counters(&stats->cache_hits,&stats->cache_misses,
+		   &stats->cache_invalidations);
+}
+
+#undef SAVE_PC
+#undef LOAD_PC
+#undef STEP
+#undef CALL_HANDLER
+#undef SET_NZ
+#undef N
+#undef Z
+#undef DIRECT_OPERAND
+#undef ALU
+#undef SET_VC
+#undef ARITH
+#undef COMPARE
@@ -0,0 +1,136 @@
+#ifndef __FLAGS__
+#define __FLAGS__
+
+/* ************************************************************************* *
+ * flags.h                                                                   *
+ * -------                                                                   *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Lazy NZVC condition codes.  The ALU helpers only record what   *
+ *            they did; the bits are worked out when a branch or the tracer  *
+ *            reads them.                                                    *
+ *                                                                           *
+ *  N and Z: every instruction that sets them sets them from a 16-bit result *
+ *  (N is bit 15, Z is result == 0), so the cpu keeps just that result.      *
+ *  V and C: only the arithmetic instructions set them, and many results     *
+ *  are never looked at, so the cpu keeps the operation and its operands.    *
+ *  ANDr, ORr, LDr and friends leave a pending V/C untouched, exactly as      *
+ *  they leave the real bits untouched.                                      *
+ * ************************************************************************* */
+
+#include <stdint.h>                     /* uint16_t */
+#include <stdbool.h>                    /* bool types */
+
+#include "interp.h"			/* cpu_t */
+
+/* What cpu_t.vc_op says about V and C */
+typedef enum vc_op {
+    VC_SET, //v and c hold the bits
+    VC_ADD, //vc_left + vc_right
+    VC_SUB, //vc_left - vc_right (SUBr, CPr)
+    VC_NEG  //0 - vc_left; NEGr sets V and leaves C alone
+} vc_op_t;
+
+/* The result preset_cpu stores so that N and Z both read 0 */
+#define NZ_CLEAR 1
+
+/* ************************************************************************* *
+ * Recording (the helpers call these; dispatch.c writes the same out)        *
+ * ************************************************************************* */
+static inline void flags_set_nz(cpu_t* pep8,uint16_t result)
+{
+    pep8->nz_result = result;
+}
+
+static inline void flags_set_vc(cpu_t* pep8,vc_op_t op,uint16_t left,
+				uint16_t right)
+{
+    pep8->vc_op = op;
+    pep8->vc_left = left;
+    pep8->vc_right = right;
+}
+
+/* ************************************************************************* *
+ * Reading                                                                   *
+ * ************************************************************************* */
+static inline _Bool flag_n(const cpu_t* pep8)
+{
+    return (pep8->nz_result >> 15) & 1;
+}
+
+static inline _Bool flag_z(const cpu_t* pep8)
+{
+    return pep8->nz_result == 0;
+}
+
+/* ************************************************************************* *
+ * Purpose: Work out V and C from the pending operation, if there is one     *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      pep8: the cpu; afterwards vc_op is VC_SET                            *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      Pep/8 subtracts by adding the two's complement, so C is the carry    *
+ *      out of left + ~right + 1: set when there is no borrow.               *
+ * ************************************************************************* */
+static inline void flags_materialize_vc(cpu_t* pep8)
+{
+    uint16_t left = pep8->vc_left;
+    uint16_t right = pep8->vc_right;
+    uint16_t result;
+    switch (pep8->vc_op)
+    {
+    case VC_ADD:
+	result = left + right;
+	pep8->v = (((left ^ result) & (right ^ result)) >> 15) & 1;
+	pep8->c = (uint32_t)left + right > 0xFFFF;
+	break;
+    case VC_SUB:
+	result = left - right;
+	pep8->v = (((left ^ right) & (left ^ result)) >> 15) & 1;
+	pep8->c = left >= right;
+	break;
+    case VC_NEG:
+	pep8->v = left == 0x8000;
+	break;
+    case VC_SET:
+	break;
+    }
+    pep8->vc_op = VC_SET;
+}
+
+/* NEGr owes only V, so whatever C is still owed must be settled first */
+static inline void flags_set_v_neg(cpu_t* pep8,uint16_t operand)
+{
+    flags_materialize_vc(pep8);
+    flags_set_vc(pep8,VC_NEG,operand,0);
+}
+
+static inline _Bool flag_v(cpu_t* pep8)
+{
+    flags_materialize_vc(pep8);
+    return pep8->v;
+}
+
+static inline _Bool flag_c(cpu_t* pep8)
+{
+    flags_materialize_vc(pep8);
+    return pep8->c;
+}
+
+/* ************************************************************************* *
+ * Purpose: Load all four bits at once (the trace decoder, MOVFLGA-style     *
+ *          writes)                                                          *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      N and Z both set cannot come from a result, and no instruction       *
+ *      produces that combination; N wins.                                   *
+ * ************************************************************************* */
+static inline void flags_set_all(cpu_t* pep8,_Bool n,_Bool z,_Bool v,_Bool c)
+{
+    pep8->nz_result = n ? 0x8000 : (z ? 0 : NZ_CLEAR);
+    pep8->vc_op = VC_SET;
+    pep8->v = v;
+    pep8->c = c;
+}
+
+#endif
@@ -17,40 +17,132 @@
 #include <stdlib.h>                     /* malloc */
 #include <inttypes.h>                   /* declares PRIu8 */
 #include <stdio.h>		        /* printf */
+#include <string.h>			/* strcmp */
 
 #include "interp.h"			/* header file */
 #include "bus.h"			/* bus methods */
 #include "processor.h"			/* instruction */
+#include "cache.h"			/* decoded-instruction cache */
+#include "flags.h"			/* condition codes */
 #include "../output/print-interp.h"	/* output interpreter */
+#include "../output/trace.h"		/* binary trace */
 #include "../main/debug.h"		/* DEBUG macros */
 /* ************************************************************************* *
  * Local function declarations                                               *
  * ************************************************************************* */
 
+/* ************************************************************************* *
+ * Global variable declarations                                              *
+ * ************************************************************************* */
+const char *ENGINES[] = {
+    "table", "threaded", "jit"
+};
+
+const char *TRACE_LEVELS[] = {
+    "full", "final", "outputs", "none"
+};
+
+/* ************************************************************************* *
+ * Purpose: Convert an engine name given to -e to an engine_t                *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      int: the engine_t, or -1 if the name is not an engine                *
+ * ************************************************************************* */
+int get_engine_by_id(const char* name)
+{
+    int index = 0;
+    for (index = 0; index < NUMBER_OF_ENGINES; index++)
+    {
+	if (strcmp(name,ENGINES[index]) == 0)
+	    return index;
+    }
+    return -1;
+}
+
+/* ************************************************************************* *
+ * Purpose: Convert a trace level name given to -l to a trace_t              *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      int: the trace_t, or -1 if the name is not a trace level             *
+ * ************************************************************************* */
+int get_trace_level_by_id(const char* name)
+{
+    int index = 0;
+    for (index = 0; index < NUMBER_OF_TRACE_LEVELS; index++)
+    {
+	if (strcmp(name,TRACE_LEVELS[index]) == 0)
+	    return index;
+    }
+    return -1;
+}
+
+/* ************************************************************************* *
+ * Purpose: Run the program in memory on the selected engine                 *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      engine: which execution engine to use                                *
+ *      memory: the bytes to interpret                                       *
+ *      pep8: the cpu object used to run the program                         *
+ *      origin: where the program was loaded; execution starts there         *
+ *      trace: how much of the run to print                                  *
+ *      stats: receives the step and decode-cache counters                   *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      memory is a whole address space from address_space_create.  Every    *
+ *      engine runs until STOP (or an instruction the interpreter stops on); *
+ *      the zeroed bytes after a program that runs off its end are STOPs.    *
+ * ************************************************************************* */
+void interpret(engine_t engine,uint8_t* memory,cpu_t* pep8,
+	       uint16_t origin,trace_t trace,interp_stats_t* stats)
+{
+    if (engine == ENGINE_THREADED)
+	interpret_threaded(memory,pep8,origin,trace,stats);
+    else if (engine == ENGINE_JIT)
+	interpret_jit(memory,pep8,origin,trace,stats);
+    else
+	interpret_memory(memory,pep8,origin,trace,stats);
+}
+
 /* ************************************************************************* *
  * Purpose: Figure out what instruction is in the pep8 inst_reg              *
  *                                                                           *
  * Parameters:                                                               *
  *      pep8: the cpu object used to decode the instruction                  *
  *	memory: the bytes to interpret					     *
- *	mem_length: the length of memory				     *
+ *	origin: the address to start at					     *
+ *	trace: how much of the run to print				     *
+ *	stats: receives the step and decode-cache counters		     *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      Decoded instructions come from the per-address cache in cache.c, so  *
+ *      a loop body is fetched and decoded once no matter how often it runs  *
+ *      and the loop never touches the heap.                                 *
  * ************************************************************************* */
-void interpret_memory(uint8_t* memory,cpu_t* pep8,uint16_t mem_length)
+void interpret_memory(uint8_t* memory,cpu_t* pep8,uint16_t origin,
+		      trace_t trace,interp_stats_t* stats)
 {
-    preset_cpu(pep8);
+    instruction_t* inst;
+    uint64_t steps = 0;
+    preset_cpu(pep8,origin);
+    pep8->trace = trace;
+    cache_reset(memory);
 
-    while (pep8->pc < mem_length)
+    while (!pep8->halted)
     {
-        pep8->inst_reg = fetch(memory,pep8->pc);//fetch
-	instruction_t *inst = malloc(sizeof(instruction_t));
-	decode(pep8,&inst);//decode
+	inst = &cache_lookup(memory,pep8)->inst;//fetch and decode
 	increment(pep8,inst);//increment
-	print_interpreter(pep8); //print out cpu
+	if (trace == TRACE_FULL)
+	    print_interpreter(pep8); //print out cpu
+	else if (trace == TRACE_BINARY)
+	    trace_record_step(pep8,steps);
 	execute(pep8,inst,memory); //execute
-	free(inst);
+	steps++;
     }
-    //stylistically since you have reached the last instruction
-    print_divider();
+    print_end_of_run(pep8);
+
+    stats->steps = steps;
+    cache_counters(&stats->cache_hits,&stats->cache_misses,
+		   &stats->cache_invalidations);
 }
 
 /* ************************************************************************* *
@@ -58,16 +150,15 @@ void interpret_memory(uint8_t* memory,cpu_t* pep8,uint16_t mem_length)
  *                                                                           *
  * Parameters:                                                               *
  *      pep8: the cpu object used to decode the instruction                  *
+ *      origin: the first instruction's address                              *
  * ************************************************************************* */
-void preset_cpu(cpu_t* pep8)
+void preset_cpu(cpu_t* pep8,uint16_t origin)
 {
     pep8->inst_reg = 0;
     pep8->accum = 0;
     pep8->x = 0;
-    pep8->pc = 0;
-    pep8->n = false;
-    pep8->z = false;
-    pep8->v = false;
-    pep8->c = false;
+    pep8->pc = origin;
+    flags_set_all(pep8,false,false,false,false);
+    pep8->halted = false;
 }
 
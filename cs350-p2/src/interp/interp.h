@@ -1,20 +1,73 @@
 #ifndef __INTERP__
 #define __INTERP__
 
+/* How much of a run is printed (-l).  TRACE_FULL is the -i trace: the cpu
+ * before every step plus every memory write and output.  The others print
+ * only the program's own DECO/CHARO output, only the cpu once the run is
+ * over, or nothing at all; at those levels no step is formatted.
+ * TRACE_BINARY has no -l name: -w selects it, and the same events go to
+ * the binary trace file (see output/trace.h) instead of stdout. */
+typedef enum trace {
+    TRACE_FULL, TRACE_FINAL, TRACE_OUTPUTS, TRACE_NONE, TRACE_BINARY
+} trace_t;
+
+#define NUMBER_OF_TRACE_LEVELS (TRACE_NONE + 1)
+
 typedef struct cpu {
     uint32_t inst_reg;// instruction register
     uint16_t accum; //accumulator
     uint16_t x; //index register
     uint16_t pc; //program counter
-    _Bool n; //n-bit, 1/true if the result is negative
-    _Bool z; //z-bit, 1/true if the result is all zeros
+    uint16_t nz_result; //N and Z are read off the last result (flags.h)
     _Bool v; //v-bit, 1/true if a signed integer overflow occurs
     _Bool c; //c bit, 1/true if an unsigned integer overflow occurs
+    uint8_t vc_op; //operation v and c are still owed from, see flags.h
+    uint16_t vc_left; //its left operand
+    uint16_t vc_right; //its right operand
+    _Bool halted; //set by STOP, ends the fetch/decode/execute loop
+    trace_t trace; //what the execute_* helpers print, set by the engine
 } cpu_t;
 
+/* Counters filled in by interpret_memory for the -t report */
+typedef struct interp_stats {
+    uint64_t steps; //instructions executed
+    uint64_t cache_hits; //steps that reused a cached decode
+    uint64_t cache_misses; //steps that had to fetch and decode
+    uint64_t cache_invalidations; //cached decodes dropped by stores
+} interp_stats_t;
+
+/* Execution engines selectable with -e */
+typedef enum engine {
+    ENGINE_TABLE, //interpret_memory: one call through OPCODES per step
+    ENGINE_THREADED, //interpret_threaded: threaded code, see dispatch.c
+    ENGINE_JIT //interpret_jit: translated basic blocks, see jit.c
+} engine_t;
+
+#define NUMBER_OF_ENGINES (ENGINE_JIT + 1)
+
+/* What decode knows about an instruction specifier, for code that only
+ * wants to ask about one without the OPCODES table and its handlers */
+typedef struct opcode_info {
+    uint8_t mnem; //a mnemonic_t
+    uint8_t registr; //DNE if does not apply to this instruction
+    uint8_t addr_mode; //DNE if unary
+    _Bool unary; //unary means no op-spec
+    _Bool supported; //false if the interpreter stops on it
+} opcode_info_t;
+
+/* Global constants defined in interp.c */
+extern const char *ENGINES[];
+extern const char *TRACE_LEVELS[];
+
 /*Prototypes*/
-void interpret_memory(uint8_t*,cpu_t*,uint16_t);
-void preset_cpu(cpu_t*);
+void interpret(engine_t,uint8_t*,cpu_t*,uint16_t,trace_t,interp_stats_t*);
+void interpret_memory(uint8_t*,cpu_t*,uint16_t,trace_t,interp_stats_t*);
+void interpret_threaded(uint8_t*,cpu_t*,uint16_t,trace_t,interp_stats_t*);
+void interpret_jit(uint8_t*,cpu_t*,uint16_t,trace_t,interp_stats_t*);
+int get_engine_by_id(const char*);
+int get_trace_level_by_id(const char*);
+void preset_cpu(cpu_t*,uint16_t);
+void describe_opcode(uint8_t,opcode_info_t*);
 
 
 #endif
@@ -0,0 +1,845 @@
+/* ************************************************************************* *
+ * jit.c                                                                     *
+ * -----                                                                     *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Basic-block translator (-e jit).  Straight-line runs of guest  *
+ *            instructions are decoded with decode() and OPCODES and turned  *
+ *            into x86-64 code in a buffer that is never writable and        *
+ *            executable at once: it is read-write only while a block is     *
+ *            emitted and patched in, and read-execute the rest of the time. *
+ *            A, X and the N/Z result live in host registers while           *
+ *            translated code runs, and a block that ends in a direct branch *
+ *            jumps straight into the block it branches to once that block   *
+ *            exists.                                                        *
+ *                                                                           *
+ *            Anything the translator does not handle (STOP, DECO, CHARO,    *
+ *            the unsupported instructions and addressing modes) is run one  *
+ *            step at a time by the interpreter, which is also used for the  *
+ *            whole run when every step has to be traced or when the host is *
+ *            not x86-64.                                                    *
+ * ************************************************************************* */
+
+
+/* ************************************************************************* *
+ * Library includes here.  For documentation of standard C library           *
+ * functions, see the list at:                                               *
+ *   http://pubs.opengroup.org/onlinepubs/009695399/functions/contents.html  *
+ * ************************************************************************* */
+
+#include <stdbool.h>                    /* bool types */
+#include <stdint.h>                     /* uint32_t, uint8_t, etc. */
+#include <stddef.h>                     /* offsetof */
+#include <string.h>                     /* memset */
+
+#include "interp.h"			/* cpu_t */
+#include "processor.h"			/* decode, increment, execute */
+#include "bus.h"			/* fetch, ADDRESS_SPACE_SIZE */
+#include "cache.h"			/* decoded-instruction cache */
+#include "flags.h"			/* condition codes */
+#include "../output/print-interp.h"	/* print_end_of_run */
+#include "../main/pep8.h"		/* mnemonics */
+
+/* ************************************************************************* *
+ * The translator needs an x86-64 host and anonymous executable mappings.    *
+ * Everywhere else -e jit runs the interpreter.                              *
+ * ************************************************************************* */
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+#define JIT_AVAILABLE
+#include <sys/mman.h>			/* mmap, mprotect */
+#include <unistd.h>			/* sysconf */
+#endif
+
+#ifdef JIT_AVAILABLE
+
+/* ************************************************************************* *
+ * Global variable declarations                                              *
+ * ************************************************************************* */
+#define JIT_CODE_SIZE (4 << 20) //translated code; flushed when it fills up
+#define JIT_MAX_BLOCK 64 //guest instructions per block
+#define JIT_BLOCK_BYTES 8192 //more than the largest block can take
+#define JIT_MAX_EXITS (2 * CACHE_SLOTS) //a block has at most two exits
+
+/* What translated code returns: the address a store hit watched bytes at,
+ * with JIT_WORD_STORE set for STr, or JIT_NO_STORE */
+#define JIT_NO_STORE -1
+#define JIT_WORD_STORE 0x10000
+
+/* Host registers, numbered as in the instruction encoding */
+enum { RAX = 0, RBX = 3, R12 = 12, R13 = 13, R14 = 14, R15 = 15 };
+
+/* Where the guest state lives while translated code runs:
+ *   rbx guest memory, rbp step counter, r12 A, r13 X, r14 N/Z result,
+ *   r15 the cpu_t.  V and C stay in the cpu_t (see flags.h). */
+#define REG_A R12
+#define REG_X R13
+#define REG_NZ R14
+
+/* Entry trampoline: runs a block until some exit returns to the caller */
+typedef int (*enter_t)(const uint8_t*,cpu_t*,uint8_t*,uint64_t*);
+
+/* A jump at the end of a block that is patched once its target exists */
+typedef struct exit_site {
+    uint8_t* jump; //the rel32 of the jmp
+    uint16_t target; //guest address it leaves for
+    int32_t next; //next site waiting on the same target, or -1
+} exit_site_t;
+
+/* A translated block and the guest bytes it was made from */
+typedef struct block {
+    uint16_t start;
+    uint16_t end; //last byte fetched, inclusive
+} block_t;
+
+/* The mapping holds the watch map first so translated code can reach it
+ * RIP-relative, then the trampoline, the shared exit and the blocks.  The
+ * watch map's pages stay read-write and are never executable; the code's
+ * pages are flipped by code_writable. */
+static uint8_t* region = NULL;
+static uint8_t* watch; //nonzero if some translation read this byte
+static uint8_t* code_start; //the first page after the watch map
+static uint8_t* blocks_start; //first byte after the trampoline and exit
+static uint8_t* code_limit;
+static uint8_t* emit_at; //where the next byte of code goes
+static enter_t enter;
+static uint8_t* common_exit;
+
+static uint8_t* block_code[CACHE_SLOTS]; //translation of each guest address
+static uint8_t untranslatable[CACHE_SLOTS]; //no block can start here
+static uint8_t covered[CACHE_SLOTS]; //bytes some block was made from
+static int32_t pending[CACHE_SLOTS]; //first exit site waiting on an address
+static exit_site_t exits[JIT_MAX_EXITS];
+static int32_t exit_count = 0;
+static block_t blocks[CACHE_SLOTS];
+static int32_t block_count = 0;
+
+/* ************************************************************************* *
+ * Code emitters.  Only the handful of encodings the blocks need.            *
+ * ************************************************************************* */
+static void emit8(uint8_t byte)
+{
+    *emit_at++ = byte;
+}
+
+static void emit16(uint16_t value)
+{
+    emit8(value);
+    emit8(value >> 8);
+}
+
+static void emit32(uint32_t value)
+{
+    emit16(value);
+    emit16(value >> 16);
+}
+
+//aim the rel32 at "at", the last field of its jump, at "to"
+static void patch_rel32(uint8_t* at,const uint8_t* to)
+{
+    int32_t rel = to - (at + 4);
+    memcpy(at,&rel,4);
+}
+
+//REX prefix, left out when it would carry no bits
+static void emit_rex(int wide,int reg,int rm)
+{
+    uint8_t rex = 0x40 | (wide << 3) | ((reg >> 3) << 2) | (rm >> 3);
+    if (rex != 0x40)
+	emit8(rex);
+}
+
+//op r/m32,r32 between two registers: add 01, or 09, and 21, sub 29, mov 89
+static void emit_alu_rr(uint8_t op,int dst,int src)
+{
+    emit_rex(0,src,dst);
+    emit8(op);
+    emit8(0xC0 | ((src & 7) << 3) | (dst & 7));
+}
+
+//op r/m32,imm32: add /0, or /1, and /4, sub /5
+static void emit_alu_ri(int ext,int dst,uint32_t imm)
+{
+    emit_rex(0,0,dst);
+    emit8(0x81);
+    emit8(0xC0 | (ext << 3) | (dst & 7));
+    emit32(imm);
+}
+
+//mov r32,imm32
+static void emit_mov_ri(int dst,uint32_t imm)
+{
+    emit_rex(0,0,dst);
+    emit8(0xB8 | (dst & 7));
+    emit32(imm);
+}
+
+//movzx r32,word [r15+offset]: read a cpu_t field
+static void emit_cpu_load16(int reg,size_t offset)
+{
+    emit_rex(0,reg,R15);
+    emit8(0x0F);
+    emit8(0xB7);
+    emit8(0x80 | ((reg & 7) << 3) | (R15 & 7));
+    emit32(offset);
+}
+
+//mov word [r15+offset],r16
+static void emit_cpu_store16(size_t offset,int reg)
+{
+    emit8(0x66);
+    emit_rex(0,reg,R15);
+    emit8(0x89);
+    emit8(0x80 | ((reg & 7) << 3) | (R15 & 7));
+    emit32(offset);
+}
+
+//mov word [r15+offset],imm16
+static void emit_cpu_store16_imm(size_t offset,uint16_t imm)
+{
+    emit8(0x66);
+    emit8(0x41);
+    emit8(0xC7);
+    emit8(0x87);
+    emit32(offset);
+    emit16(imm);
+}
+
+//mov dword [r15+offset],imm32
+static void emit_cpu_store32_imm(size_t offset,uint32_t imm)
+{
+    emit8(0x41);
+    emit8(0xC7);
+    emit8(0x87);
+    emit32(offset);
+    emit32(imm);
+}
+
+//mov byte [r15+offset],imm8
+static void emit_cpu_store8_imm(size_t offset,uint8_t imm)
+{
+    emit8(0x41);
+    emit8(0xC6);
+    emit8(0x87);
+    emit32(offset);
+    emit8(imm);
+}
+
+//eax = the big-endian guest word at address
+static void emit_load_guest_word(uint16_t address)
+{
+    emit8(0x0F); emit8(0xB7); emit8(0x83); emit32(address); //movzx eax,[rbx+]
+    emit8(0x66); emit8(0xC1); emit8(0xC0); emit8(0x08); //rol ax,8
+}
+
+//the guest word at address = the low 16 bits of reg, big-endian
+static void emit_store_guest_word(uint16_t address,int reg)
+{
+    emit_alu_rr(0x89,RAX,reg); //mov eax,reg
+    emit8(0x66); emit8(0xC1); emit8(0xC0); emit8(0x08); //rol ax,8
+    emit8(0x66); emit8(0x89); emit8(0x83); emit32(address); //mov [rbx+],ax
+}
+
+//the guest byte at address = the low 8 bits of reg
+static void emit_store_guest_byte(uint16_t address,int reg)
+{
+    emit_alu_rr(0x89,RAX,reg); //mov eax,reg
+    emit8(0x88); emit8(0x83); emit32(address); //mov [rbx+],al
+}
+
+//jmp rel32 to an address that is already known
+static void emit_jump(const uint8_t* to)
+{
+    emit8(0xE9);
+    emit32(0);
+    patch_rel32(emit_at - 4,to);
+}
+
+//steps += count (add rbp,imm32)
+static void emit_count_steps(unsigned count)
+{
+    emit8(0x48);
+    emit8(0x81);
+    emit8(0xC5);
+    emit32(count);
+}
+
+//store the pc and IR a return to the interpreter has to leave behind
+static void emit_leave(uint16_t pc,uint32_t inst_reg,int32_t result)
+{
+    emit_cpu_store16_imm(offsetof(cpu_t,pc),pc);
+    emit_cpu_store32_imm(offsetof(cpu_t,inst_reg),inst_reg);
+    emit_mov_ri(RAX,result);
+    emit_jump(common_exit);
+}
+
+/* ************************************************************************* *
+ * Purpose: Build the trampoline that enters translated code and the exit    *
+ *          every block returns through                                      *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      enter(code,pep8,memory,steps) saves the callee-saved registers,      *
+ *      loads the guest registers and jumps to code.  The exit writes them   *
+ *      back, stores the step counter and returns eax.                       *
+ * ************************************************************************* */
+static void emit_runtime()
+{
+    enter = (enter_t)emit_at;
+    emit8(0x53); emit8(0x55); //push rbx; push rbp
+    emit8(0x41); emit8(0x54); emit8(0x41); emit8(0x55); //push r12; push r13
+    emit8(0x41); emit8(0x56); emit8(0x41); emit8(0x57); //push r14; push r15
+    emit8(0x51); //push rcx (the step counter's address)
+    emit8(0x49); emit8(0x89); emit8(0xF7); //mov r15,rsi
+    emit8(0x48); emit8(0x89); emit8(0xD3); //mov rbx,rdx
+    emit8(0x48); emit8(0x8B); emit8(0x29); //mov rbp,[rcx]
+    emit_cpu_load16(REG_A,offsetof(cpu_t,accum));
+    emit_cpu_load16(REG_X,offsetof(cpu_t,x));
+    emit_cpu_load16(REG_NZ,offsetof(cpu_t,nz_result));
+    emit8(0xFF); emit8(0xE7); //jmp rdi
+
+    common_exit = emit_at;
+    emit_cpu_store16(offsetof(cpu_t,accum),REG_A);
+    emit_cpu_store16(offsetof(cpu_t,x),REG_X);
+    emit_cpu_store16(offsetof(cpu_t,nz_result),REG_NZ);
+    emit8(0x59); //pop rcx
+    emit8(0x48); emit8(0x89); emit8(0x29); //mov [rcx],rbp
+    emit8(0x41); emit8(0x5F); emit8(0x41); emit8(0x5E); //pop r15; pop r14
+    emit8(0x41); emit8(0x5D); emit8(0x41); emit8(0x5C); //pop r13; pop r12
+    emit8(0x5D); emit8(0x5B); //pop rbp; pop rbx
+    emit8(0xC3); //ret
+}
+
+/* ************************************************************************* *
+ * Purpose: Make the code buffer writable, or executable again               *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      writable: true to emit or patch code, false to run it                *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      bool: false if the host refused the change                           *
+ * ************************************************************************* */
+static bool code_writable(bool writable)
+{
+    return mprotect(code_start,code_limit - code_start,
+		    writable ? PROT_READ | PROT_WRITE
+			     : PROT_READ | PROT_EXEC) == 0;
+}
+
+/* ************************************************************************* *
+ * Purpose: Map the code buffer the first time the engine runs               *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      0 - if success                                                       *
+ *      1 - if the host will not give us executable memory                   *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      The buffer is mapped read-write and made read-execute once the       *
+ *      trampoline is in it.  The watch map is rounded up to whole pages so  *
+ *      that changing the code's protection never touches it.                *
+ * ************************************************************************* */
+static int jit_init()
+{
+    if (region != NULL)
+	return 0;
+
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t watch_size = (CACHE_SLOTS + 16 + page - 1) & ~(page - 1);
+    void* map = mmap(NULL,watch_size + JIT_CODE_SIZE,PROT_READ | PROT_WRITE,
+		     MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+    if (map == MAP_FAILED)
+	return 1;
+
+    watch = map;
+    code_start = emit_at = watch + watch_size;
+    code_limit = code_start + JIT_CODE_SIZE;
+    emit_runtime();
+    blocks_start = emit_at;
+    if (!code_writable(false))
+    {
+	munmap(map,watch_size + JIT_CODE_SIZE);
+	return 1;
+    }
+    region = map;
+    memset(pending,0xFF,sizeof(pending)); //every list starts empty (-1)
+    return 0;
+}
+
+/* ************************************************************************* *
+ * Purpose: Throw every translation away                                     *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      Used when a store hits translated bytes and when the buffer fills.   *
+ *      Only the entries the old blocks touched are cleared.  The watch map  *
+ *      is left alone: a byte that is still watched only costs a return to   *
+ *      the interpreter when it is stored to.                                *
+ * ************************************************************************* */
+static void flush_translations()
+{
+    int32_t i = 0;
+    for (i = 0; i < block_count; i++)
+    {
+	block_code[blocks[i].start] = NULL;
+	memset(covered + blocks[i].start,0,
+	       blocks[i].end - blocks[i].start + 1);
+    }
+    for (i = 0; i < exit_count; i++)
+	pending[exits[i].target] = -1;
+    block_count = 0;
+    exit_count = 0;
+    emit_at = blocks_start;
+}
+
+/* ************************************************************************* *
+ * Purpose: Deal with a guest store that may have hit code                   *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      address: the first byte stored                                       *
+ *      word: true for STr, which also stores address + 1                    *
+ * ************************************************************************* */
+static void store_hit(uint16_t address,_Bool word)
+{
+    int i = 0;
+    cache_invalidate(address);
+    if (word)
+	cache_invalidate(address + 1);
+    for (i = -2; i <= word; i++) //instructions the new bytes are part of
+	untranslatable[(uint16_t)(address + i)] = 0;
+    if (covered[address] || (word && covered[(uint16_t)(address + 1)]))
+	flush_translations();
+}
+
+/* ************************************************************************* *
+ * Purpose: Decode the instruction at pc if its fetch does not wrap          *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      memory: the bytes to interpret                                       *
+ *      pc: the guest address                                                *
+ *      inst: receives the decoded instruction                               *
+ *      inst_reg: receives the three fetched bytes                           *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      bool: false if the fetch runs past 0xFFFF; the interpreter takes     *
+ *            those, so covered and the watch map never need to wrap         *
+ * ************************************************************************* */
+static bool decode_at(uint8_t* memory,uint16_t pc,instruction_t* inst,
+		      uint32_t* inst_reg)
+{
+    cpu_t scratch;
+    if (pc > ADDRESS_SPACE_SIZE - 3)
+	return false;
+    scratch.pc = pc;
+    scratch.inst_reg = fetch(memory,pc);
+    decode(&scratch,inst);
+    *inst_reg = scratch.inst_reg;
+    return true;
+}
+
+/* ************************************************************************* *
+ * Purpose: Decide whether the translator handles an instruction             *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      Only the cases whose execute_* helper does the obvious thing are     *
+ *      translated.  The rest, including ORX in direct mode (the helper ORs  *
+ *      in the operand specifier), NOTr, NEGr and LDBYTEr, are left to the   *
+ *      interpreter so both engines agree.  A word load at 0xFFFF reads the  *
+ *      mirrored byte 0, but a word store there is left to the interpreter:  *
+ *      its watch check would look at the wrong second byte.                 *
+ * ************************************************************************* */
+static bool translatable(instruction_t* inst)
+{
+    switch (inst->mnem)
+    {
+    case BR: case BRLE: case BRLT: case BREQ: case BRNE: case BRGE: case BRGT:
+    case CPA: case CPX: //execute_cpr always uses op_spec
+	return true;
+    case ADDA: case ADDX: case SUBA: case SUBX: case ANDA: case ANDX:
+    case ORA: case LDA: case LDX:
+	return inst->addr_mode == 0 || inst->addr_mode == 1;
+    case ORX:
+	return inst->addr_mode == 0;
+    case STA: case STX:
+	return inst->addr_mode == 1 && inst->op_spec != 0xFFFF;
+    case STBYTEA: case STBYTEX:
+	return inst->addr_mode == 1;
+    default:
+	return false;
+    }
+}
+
+/* ************************************************************************* *
+ * Purpose: End a block by going to a guest address                          *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      target: the guest address to continue at                             *
+ *      count: guest instructions the block ran to get here                  *
+ *      inst_reg: the IR of the last of them                                 *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      The jmp goes to the return path below it until target has a block;   *
+ *      from then on it goes straight to that block.                         *
+ * ************************************************************************* */
+static void emit_exit(uint16_t target,unsigned count,uint32_t inst_reg)
+{
+    emit_count_steps(count);
+    emit8(0xE9);
+    emit32(0);
+    uint8_t* jump = emit_at - 4;
+    patch_rel32(jump,emit_at);
+    emit_leave(target,inst_reg,JIT_NO_STORE);
+
+    if (block_code[target] != NULL)
+	patch_rel32(jump,block_code[target]);
+    else
+    {
+	exits[exit_count].jump = jump;
+	exits[exit_count].target = target;
+	exits[exit_count].next = pending[target];
+	pending[target] = exit_count++;
+    }
+}
+
+/* ************************************************************************* *
+ * Purpose: After a store, return to the interpreter if the bytes stored to  *
+ *          were ever fetched as code                                        *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      inst: the STr or STBYTEr                                             *
+ *      count: guest instructions the block has run, this one included       *
+ *      inst_reg: its IR                                                     *
+ *      next: the address after it                                           *
+ * ************************************************************************* */
+static void emit_store_check(instruction_t* inst,unsigned count,
+			     uint32_t inst_reg,uint16_t next)
+{
+    _Bool word = inst->mnem == STA || inst->mnem == STX;
+    if (word)
+    {
+	emit8(0x66); emit8(0x83); emit8(0x3D); //cmp word [rip+],0
+    }
+    else
+    {
+	emit8(0x80); emit8(0x3D); //cmp byte [rip+],0
+    }
+    emit32(0);
+    emit8(0);
+    int32_t rel = (watch + inst->op_spec) - emit_at; //from after the imm8
+    memcpy(emit_at - 5,&rel,4);
+
+    emit8(0x74); //je over the return
+    emit8(0);
+    uint8_t* skip = emit_at - 1;
+    emit_count_steps(count);
+    emit_leave(next,inst_reg,inst->op_spec | (word ? JIT_WORD_STORE : 0));
+    *skip = emit_at - (skip + 1);
+}
+
+/* ************************************************************************* *
+ * Purpose: Emit the code for one straight-line instruction                  *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      inst: a translatable instruction that is not a branch                *
+ * ************************************************************************* */
+static void emit_instruction(instruction_t* inst)
+{
+    int reg = inst->registr == 0 ? REG_A : REG_X;
+    _Bool direct = inst->addr_mode == 1;
+    uint16_t op_spec = inst->op_spec;
+
+    switch (inst->mnem)
+    {
+    case LDA: case LDX:
+	if (direct)
+	{
+	    emit_load_guest_word(op_spec);
+	    emit_alu_rr(0x89,reg,RAX);
+	}
+	else
+	    emit_mov_ri(reg,op_spec);
+	break;
+    case ADDA: case ADDX: case SUBA: case SUBX:
+    {
+	_Bool add = inst->mnem == ADDA || inst->mnem == ADDX;
+	emit_cpu_store8_imm(offsetof(cpu_t,vc_op),add ? VC_ADD : VC_SUB);
+	emit_cpu_store16(offsetof(cpu_t,vc_left),reg);
+	if (direct)
+	{
+	    emit_load_guest_word(op_spec);
+	    emit_cpu_store16(offsetof(cpu_t,vc_right),RAX);
+	    emit_alu_rr(add ? 0x01 : 0x29,reg,RAX);
+	}
+	else
+	{
+	    emit_cpu_store16_imm(offsetof(cpu_t,vc_right),op_spec);
+	    emit_alu_ri(add ? 0 : 5,reg,op_spec);
+	}
+	break;
+    }
+    case ANDA: case ANDX: case ORA: case ORX:
+    {
+	_Bool is_and = inst->mnem == ANDA || inst->mnem == ANDX;
+	if (direct)
+	{
+	    emit_load_guest_word(op_spec);
+	    emit_alu_rr(is_and ? 0x21 : 0x09,reg,RAX);
+	}
+	else
+	    emit_alu_ri(is_and ? 4 : 1,reg,op_spec);
+	break;
+    }
+    case CPA: case CPX:
+	emit_cpu_store8_imm(offsetof(cpu_t,vc_op),VC_SUB);
+	emit_cpu_store16(offsetof(cpu_t,vc_left),reg);
+	emit_cpu_store16_imm(offsetof(cpu_t,vc_right),op_spec);
+	emit_alu_rr(0x89,REG_NZ,reg);
+	emit_alu_ri(5,REG_NZ,op_spec);
+	return;
+    case STA: case STX:
+	emit_store_guest_word(op_spec,reg);
+	return;
+    case STBYTEA: case STBYTEX:
+	emit_store_guest_byte(op_spec,reg);
+	return;
+    default:
+	return;
+    }
+    emit_alu_rr(0x89,REG_NZ,reg); //n and z come from the new value
+}
+
+/* ************************************************************************* *
+ * Purpose: Emit a branch and the two ways out of the block                  *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      After test r14w,r14w SF is N and ZF is Z (OF is clear), so the       *
+ *      signed jcc conditions are exactly the Pep/8 ones.                    *
+ * ************************************************************************* */
+static void emit_branch(instruction_t* inst,unsigned count,uint32_t inst_reg,
+			uint16_t next)
+{
+    uint8_t condition;
+    switch (inst->mnem)
+    {
+    case BRLE: condition = 0xE; break; //jle: N or Z
+    case BRLT: condition = 0xC; break; //jl: N
+    case BREQ: condition = 0x4; break; //je: Z
+    case BRNE: condition = 0x5; break; //jne: not Z
+    case BRGE: condition = 0xD; break; //jge: not N
+    case BRGT: condition = 0xF; break; //jg: neither
+    default: //BR
+	emit_exit(inst->op_spec,count,inst_reg);
+	return;
+    }
+
+    emit8(0x66); emit8(0x45); emit8(0x85); emit8(0xF6); //test r14w,r14w
+    emit8(0x0F);
+    emit8(0x80 | (condition ^ 1)); //not taken: over the taken exit
+    emit32(0);
+    uint8_t* skip = emit_at - 4;
+    emit_exit(inst->op_spec,count,inst_reg);
+    patch_rel32(skip,emit_at);
+    emit_exit(next,count,inst_reg);
+}
+
+/* ************************************************************************* *
+ * Purpose: Emit the block starting at a guest address                       *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      memory: the bytes to interpret                                       *
+ *      start: the guest address                                             *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      uint8_t*: the block's code, or NULL if the instruction at start is   *
+ *                one the interpreter has to run                             *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      A block runs until a branch, an instruction it cannot translate, the *
+ *      top of memory or JIT_MAX_BLOCK instructions.  Exits that were        *
+ *      waiting for start are pointed at the new block.  The code buffer     *
+ *      must be writable (see translate).                                    *
+ * ************************************************************************* */
+static uint8_t* emit_block(uint8_t* memory,uint16_t start)
+{
+    if (code_limit - emit_at < JIT_BLOCK_BYTES)
+	flush_translations();
+
+    uint8_t* code = emit_at;
+    uint16_t pc = start;
+    uint16_t last_byte = start;
+    uint32_t inst_reg = 0;
+    unsigned count = 0;
+    bool ended = false;
+    while (count < JIT_MAX_BLOCK)
+    {
+	instruction_t inst;
+	uint32_t fetched;
+	if (!decode_at(memory,pc,&inst,&fetched) || !translatable(&inst))
+	    break;
+
+	uint16_t next = pc + (inst.unary ? 1 : 3);
+	memset(covered + pc,1,3);
+	memset(watch + pc,1,3);
+	last_byte = pc + 2;
+	inst_reg = fetched;
+	count++;
+	if (inst.mnem >= BR && inst.mnem <= BRGT)
+	{
+	    emit_branch(&inst,count,inst_reg,next);
+	    ended = true;
+	    break;
+	}
+	emit_instruction(&inst);
+	if (inst.mnem == STA || inst.mnem == STX || inst.mnem == STBYTEA ||
+	    inst.mnem == STBYTEX)
+	    emit_store_check(&inst,count,inst_reg,next);
+	pc = next;
+    }
+
+    if (count == 0)
+	return NULL;
+    if (!ended)
+	emit_exit(pc,count,inst_reg);
+
+    blocks[block_count].start = start;
+    blocks[block_count].end = last_byte;
+    block_count++;
+    block_code[start] = code;
+    int32_t site = pending[start];
+    for (; site >= 0; site = exits[site].next)
+	patch_rel32(exits[site].jump,code);
+    pending[start] = -1;
+    return code;
+}
+
+/* ************************************************************************* *
+ * Purpose: Translate the block starting at a guest address                  *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      memory: the bytes to interpret                                       *
+ *      start: the guest address                                             *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      uint8_t*: the block's code, or NULL if the interpreter has to run    *
+ *                the instruction at start                                   *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      Emitting the block and patching the exits that wait on it are the    *
+ *      only writes to the code buffer, so it is writable only around        *
+ *      emit_block.  If it cannot be made executable again every             *
+ *      translation is dropped, since none of them could run.                *
+ *                                                                           *
+ *      An address whose instruction the interpreter has to run is marked    *
+ *      untranslatable, so the steps that run there later neither decode it  *
+ *      again nor change the buffer's protection.  store_hit clears the mark *
+ *      when the instruction's bytes change.                                 *
+ * ************************************************************************* */
+static uint8_t* translate(uint8_t* memory,uint16_t start)
+{
+    instruction_t inst;
+    uint32_t fetched;
+    if (untranslatable[start])
+	return NULL;
+    if (!decode_at(memory,start,&inst,&fetched) || !translatable(&inst))
+    {
+	untranslatable[start] = 1;
+	return NULL;
+    }
+    if (!code_writable(true))
+	return NULL;
+    uint8_t* code = emit_block(memory,start);
+    if (!code_writable(false))
+    {
+	flush_translations();
+	return NULL;
+    }
+    return code;
+}
+
+/* ************************************************************************* *
+ * Purpose: Run the program, translated where possible                       *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      Same loop as interpret_memory, except that a pc with a block runs    *
+ *      the block.  The decode-cache counters cover only the steps the       *
+ *      interpreter ran.  A store by translated code only drops decodes      *
+ *      whose bytes are watched, so the ones cache_reset made before the     *
+ *      run are watched from the start.                                      *
+ * ************************************************************************* */
+static void run_translated(uint8_t* memory,cpu_t* pep8,uint16_t origin,
+			   trace_t trace,interp_stats_t* stats)
+{
+    uint64_t steps = 0;
+    int i = 0;
+    preset_cpu(pep8,origin);
+    pep8->trace = trace;
+    size_t preloaded = cache_reset(memory);
+    flush_translations();
+    memset(watch,0,CACHE_SLOTS);
+    memset(untranslatable,0,CACHE_SLOTS);
+    for (i = 0; preloaded > 0 && i < CACHE_SLOTS; i++) //see cache_reset
+    {
+	if (cache_valid[i])
+	{
+	    watch[i] = 1;
+	    watch[(uint16_t)(i + 1)] = 1;
+	    watch[(uint16_t)(i + 2)] = 1;
+	}
+    }
+
+    while (!pep8->halted)
+    {
+	uint16_t pc = pep8->pc;
+	uint8_t* code = block_code[pc];
+	if (code == NULL)
+	    code = translate(memory,pc);
+	if (code != NULL)
+	{
+	    int stored = enter(code,pep8,memory,&steps);
+	    if (stored != JIT_NO_STORE)
+		store_hit(stored,stored & JIT_WORD_STORE);
+	    continue;
+	}
+
+	instruction_t* inst = &cache_lookup(memory,pep8)->inst;
+	for (i = 0; i < 3; i++) //a store must drop this decode too
+	    watch[(uint16_t)(pc + i)] = 1;
+	increment(pep8,inst);
+	execute(pep8,inst,memory);
+	steps++;
+	if (inst->addr_mode == 1 &&
+	    (inst->mnem == STA || inst->mnem == STX ||
+	     inst->mnem == STBYTEA || inst->mnem == STBYTEX))
+	    store_hit(inst->op_spec,inst->mnem == STA || inst->mnem == STX);
+    }
+    print_end_of_run(pep8);
+
+    stats->steps = steps;
+    cache_counters(&stats->cache_hits,&stats->cache_misses,
+		   &stats->cache_invalidations);
+}
+
+#endif
+
+/* ************************************************************************* *
+ * Purpose: Run the program in memory on the basic-block translator          *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      memory: the bytes to interpret                                       *
+ *      pep8: the cpu object used to run the program                         *
+ *      origin: the address to start at                                      *
+ *      trace: how much of the run to print                                  *
+ *      stats: receives the step and decode-cache counters                   *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      The full and binary traces need the cpu before every step, so those  *
+ *      runs, and every run on a host without the translator, go to          *
+ *      interpret_memory.                                                    *
+ * ************************************************************************* */
+void interpret_jit(uint8_t* memory,cpu_t* pep8,uint16_t origin,
+		   trace_t trace,interp_stats_t* stats)
+{
+#ifdef JIT_AVAILABLE
+    if (trace != TRACE_FULL && trace != TRACE_BINARY && jit_init() == 0)
+    {
+	run_translated(memory,pep8,origin,trace,stats);
+	return;
+    }
+#endif
+    interpret_memory(memory,pep8,origin,trace,stats);
+}
@@ -0,0 +1,82 @@
+#ifndef __PROC_CONST__
+#define __PROC_CONST__
+
+#include <stdint.h>     /* uint8_t */
+#include <stdbool.h>	/* true/false */
+
+#include "processor.h"	/* opcode_t */
+#include "proc-helper.h"/* execute_* handlers */
+
+/* ************************************************************************* *
+ * Entry helpers.  Everything decode needs except the operand specifier is a *
+ * function of the instruction specifier alone, so each opcode gets its own  *
+ * entry with the addressing mode already extracted:                         *
+ *   UNARY -- one unary opcode (no operand specifier, no addressing mode)    *
+ *   A     -- the 2 opcodes of an "a" (i,x) instruction                      *
+ *   AAA   -- the 8 opcodes of an "aaa" instruction                          *
+ * ************************************************************************* */
+#define OP(m,r,a,u,fn)  { m, r, a, u, fn }
+#define UNARY(m,r,fn)   OP(m,r,DNE,true,fn)
+#define A(m,fn)         OP(m,DNE,0,false,fn), OP(m,DNE,1,false,fn)
+#define AAA(m,r,fn)     OP(m,r,0,false,fn), OP(m,r,1,false,fn), \
+                        OP(m,r,2,false,fn), OP(m,r,3,false,fn), \
+                        OP(m,r,4,false,fn), OP(m,r,5,false,fn), \
+                        OP(m,r,6,false,fn), OP(m,r,7,false,fn)
+
+#define UNSUPPORTED execute_unsupported
+
+const opcode_t OPCODES[256] = {
+    /* 0x00 */ UNARY(STOP,0,execute_stop), UNARY(RETTR,1,UNSUPPORTED),
+    /* 0x02 */ UNARY(MOVSPA,0,UNSUPPORTED), UNARY(MOVFLGA,1,UNSUPPORTED),
+    /* 0x04 */ A(BR,execute_br), A(BRLE,execute_brle),
+    /* 0x08 */ A(BRLT,execute_brlt), A(BREQ,execute_breq),
+    /* 0x0C */ A(BRNE,execute_brne), A(BRGE,execute_brge),
+    /* 0x10 */ A(BRGT,execute_brgt), A(BRV,UNSUPPORTED),
+    /* 0x14 */ A(BRC,UNSUPPORTED), A(CALL,UNSUPPORTED),
+    /* 0x18 */ UNARY(NOTA,0,execute_notr), UNARY(NOTX,1,execute_notr),
+    /* 0x1A */ UNARY(NEGA,0,execute_negr), UNARY(NEGX,1,execute_negr),
+    /* 0x1C */ UNARY(ASLA,0,UNSUPPORTED), UNARY(ASLX,1,UNSUPPORTED),
+    /* 0x1E */ UNARY(ASRA,0,UNSUPPORTED), UNARY(ASRX,1,UNSUPPORTED),
+    /* 0x20 */ UNARY(ROLA,0,UNSUPPORTED), UNARY(ROLX,1,UNSUPPORTED),
+    /* 0x22 */ UNARY(RORA,0,UNSUPPORTED), UNARY(RORX,1,UNSUPPORTED),
+    /* 0x24 */ UNARY(NOP0,0,UNSUPPORTED), UNARY(NOP1,1,UNSUPPORTED),
+    /* 0x26 */ UNARY(NOP2,0,UNSUPPORTED), UNARY(NOP3,1,UNSUPPORTED),
+    /* 0x28 */ AAA(NOP,DNE,UNSUPPORTED),
+    /* 0x30 */ AAA(DECI,DNE,UNSUPPORTED),
+    /* 0x38 */ AAA(DECO,DNE,execute_deco),
+    /* 0x40 */ AAA(STRO,DNE,UNSUPPORTED),
+    /* 0x48 */ AAA(CHARI,DNE,UNSUPPORTED),
+    /* 0x50 */ AAA(CHARO,DNE,execute_charo),
+    /* 0x58 */ UNARY(RET0,0,UNSUPPORTED), UNARY(RET1,1,UNSUPPORTED),
+    /* 0x5A */ UNARY(RET2,0,UNSUPPORTED), UNARY(RET3,1,UNSUPPORTED),
+    /* 0x5C */ UNARY(RET4,0,UNSUPPORTED), UNARY(RET5,1,UNSUPPORTED),
+    /* 0x5E */ UNARY(RET6,0,UNSUPPORTED), UNARY(RET7,1,UNSUPPORTED),
+    /* 0x60 */ AAA(ADDSP,DNE,UNSUPPORTED),
+    /* 0x68 */ AAA(SUBSP,DNE,UNSUPPORTED),
+    /* 0x70 */ AAA(ADDA,0,execute_addr),
+    /* 0x78 */ AAA(ADDX,1,execute_addr),
+    /* 0x80 */ AAA(SUBA,0,execute_subr),
+    /* 0x88 */ AAA(SUBX,1,execute_subr),
+    /* 0x90 */ AAA(ANDA,0,execute_andr),
+    /* 0x98 */ AAA(ANDX,1,execute_andr),
+    /* 0xA0 */ AAA(ORA,0,execute_orr),
+    /* 0xA8 */ AAA(ORX,1,execute_orr),
+    /* 0xB0 */ AAA(CPA,0,execute_cpr),
+    /* 0xB8 */ AAA(CPX,1,execute_cpr),
+    /* 0xC0 */ AAA(LDA,0,execute_ldr),
+    /* 0xC8 */ AAA(LDX,1,execute_ldr),
+    /* 0xD0 */ AAA(LDBYTEA,0,execute_ldbyter),
+    /* 0xD8 */ AAA(LDBYTEX,1,execute_ldbyter),
+    /* 0xE0 */ AAA(STA,0,execute_str),
+    /* 0xE8 */ AAA(STX,1,execute_str),
+    /* 0xF0 */ AAA(STBYTEA,0,execute_stbyter),
+    /* 0xF8 */ AAA(STBYTEX,1,execute_stbyter)
+};
+
+#undef OP
+#undef UNARY
+#undef A
+#undef AAA
+#undef UNSUPPORTED
+
+#endif
@@ -18,9 +18,9 @@
 #include <inttypes.h>                   /* declares PRIu8 */
 #include <stdio.h>			/* printf */
 #include <string.h>			/* strncmp */
-#include <ctype.h>			/* isprint */
 
 #include "proc-helper.h"		/* header file */
+#include "flags.h"			/* condition codes */
 #include "bus.h"			/* access bus methods */
 #include "interp.h"			/* instructions */
 #include "../main/debug.h"		/* DEBUG macros */
@@ -29,38 +29,6 @@
  * Local function declarations                                               *
  * ************************************************************************* */
 
-/* ************************************************************************* *
- * Purpose: Execute the instruction inst                                     *
- *                                                                           *
- * Parameters:                                                               *
- *      pep8: the cpu object used to determine the instruction               *
- *      inst: the instruction to execute                                     *
- *      memory: the bytes of memory that the instruction may use/affect      *
- * ************************************************************************* */
-void execute_arithmetic_and_logic_operators(cpu_t* pep8,instruction_t* inst,
-					    uint8_t* memory)
-{
-    uint8_t mnem = inst->mnem;
-
-    if (mnem == 46 || mnem == 47) //ADDA and ADDX
-	execute_addr(pep8,inst,memory);
-    else if (mnem == 48 || mnem == 49) //SUBA and SUBX
-        execute_subr(pep8,inst,memory);
-    else if (mnem == 50 || mnem == 51) //ANDA and ANDX
-        execute_andr(pep8,inst,memory);
-    else if (mnem == 52 || mnem == 53) //ORA and ORX
-        execute_orr(pep8,inst,memory);
-    else if (mnem == 54 || mnem == 55) //CPA and CPX
-        execute_cpr(pep8,inst,memory);
-    else if (mnem == 14 || mnem == 15) //NOTA and NOTX
-        execute_notr(pep8,inst,memory);
-    else if (mnem == 16 || mnem == 17) //NEGA and NEGX
-        execute_negr(pep8,inst,memory);
-    else
-	printf("execute_arithmetic error\n");
-
-}
-
 /* ************************************************************************* *
  * Purpose: Execute the instruction ADDr                                     *
  *                                                                           *
@@ -86,15 +54,15 @@ void execute_addr(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
     
     if (inst->mnem == 46) //ADDA
     {
+	flags_set_vc(pep8,VC_ADD,pep8->accum,temp); //v and c bits
 	pep8->accum += temp;
-        pep8->z = pep8->accum == 0 ? true:false; //set z bit
-        pep8->n = ((pep8->accum>>15) & 1) == 1 ? true:false; //set n bit
+        flags_set_nz(pep8,pep8->accum); //n and z bits
     }
     else //ADDX
     {
+	flags_set_vc(pep8,VC_ADD,pep8->x,temp); //v and c bits
 	pep8->x += temp;
-        pep8->z = pep8->x == 0 ? true:false; //set z bit
-        pep8->n = ((pep8->x>>15) & 1) == 1 ? true:false; //set n bit
+        flags_set_nz(pep8,pep8->x); //n and z bits
     }
 
 }
@@ -123,15 +91,15 @@ void execute_subr(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
 
     if (inst->mnem == 48) //SUBA
     {
+	flags_set_vc(pep8,VC_SUB,pep8->accum,temp); //v and c bits
         pep8->accum -= temp;
-        pep8->z = pep8->accum == 0 ? true:false; //set z bit
-        pep8->n = ((pep8->accum>>15) & 1) == 1 ? true:false; //set n bit
+        flags_set_nz(pep8,pep8->accum); //n and z bits
     }
     else //SUBX
     {
+	flags_set_vc(pep8,VC_SUB,pep8->x,temp); //v and c bits
         pep8->x -= temp;
-        pep8->z = pep8->x == 0 ? true:false; //set z bit
-        pep8->n = ((pep8->x>>15) & 1) == 1 ? true:false; //set n bit
+        flags_set_nz(pep8,pep8->x); //n and z bits
     }
 }
 
@@ -160,14 +128,12 @@ void execute_andr(cpu_t* pep8,instruction_t* inst, uint8_t* memory)
     if (inst->mnem == 50) //ANDA
     {
         pep8->accum &= temp;
-        pep8->z = pep8->accum == 0 ? true:false; //set z bit
-        pep8->n = ((pep8->accum>>15) & 1) == 1 ? true:false; //set n bit
+        flags_set_nz(pep8,pep8->accum); //n and z bits
     }
     else //ANDX
     {
         pep8->x &= temp;
-        pep8->z = pep8->x == 0 ? true:false; //set z bit
-        pep8->n = ((pep8->x>>15) & 1) == 1 ? true:false; //set n bit
+        flags_set_nz(pep8,pep8->x); //n and z bits
     }
 }
 
@@ -193,20 +159,15 @@ void execute_orr(cpu_t* pep8,instruction_t* inst, uint8_t* memory)
     else
         print_unsupported_addr_mode(inst);
 
-    pep8->z = temp == 0 ? true:false; //set z bit
-    pep8->n = ((temp>>15) & 1) == 1 ? true:false; //set n bit
-
     if (inst->mnem == 52) //ORA
     {
         pep8->accum |= temp;
-        pep8->z = pep8->accum == 0 ? true:false; //set z bit
-        pep8->n = ((pep8->accum>>15) & 1) == 1 ? true:false; //set n bit
+        flags_set_nz(pep8,pep8->accum); //n and z bits
     }
     else //ORX
     {
         pep8->x |= inst->op_spec;
-        pep8->z = pep8->x == 0 ? true:false; //set z bit
-        pep8->n = ((pep8->x>>15) & 1) == 1 ? true:false; //set n bit
+        flags_set_nz(pep8,pep8->x); //n and z bits
     }
 }
 
@@ -220,19 +181,14 @@ void execute_orr(cpu_t* pep8,instruction_t* inst, uint8_t* memory)
  * ************************************************************************* */
 void execute_cpr(cpu_t* pep8,instruction_t* inst, uint8_t* memory)
 {
-    int16_t temp;
+    uint16_t reg;
     if (inst->mnem == 54) //CPA
-    {
-	temp = pep8->accum - inst->op_spec;
-    }
+	reg = pep8->accum;
     else //CPX
-    {
-	temp = pep8->x - inst->op_spec;
-    }
-    
-    pep8->z = temp == 0 ? true:false; //set z bit
-    pep8->n = temp < 0 ? true:false; //set n bit
-   
+	reg = pep8->x;
+
+    flags_set_vc(pep8,VC_SUB,reg,inst->op_spec); //v and c bits
+    flags_set_nz(pep8,reg - inst->op_spec); //n and z bits
 }
 
 /* ************************************************************************* *
@@ -246,9 +202,15 @@ void execute_cpr(cpu_t* pep8,instruction_t* inst, uint8_t* memory)
 void execute_notr(cpu_t* pep8,instruction_t* inst, uint8_t* memory)
 {
     if (inst->mnem == 14) //NOTA
+    {
         pep8->accum = flip_bits(pep8->accum);
+        flags_set_nz(pep8,pep8->accum); //n and z bits
+    }
     else //NOTX
+    {
         pep8->x = flip_bits(pep8->x);
+        flags_set_nz(pep8,pep8->x); //n and z bits
+    }
 }
 
 /* ************************************************************************* *
@@ -262,9 +224,17 @@ void execute_notr(cpu_t* pep8,instruction_t* inst, uint8_t* memory)
 void execute_negr(cpu_t* pep8,instruction_t* inst, uint8_t* memory)
 {
     if (inst->mnem == 16) //NEGA
+    {
+	flags_set_v_neg(pep8,pep8->accum); //v bit
         pep8->accum = flip_bits(pep8->accum) + 1;
+        flags_set_nz(pep8,pep8->accum); //n and z bits
+    }
     else //NEGX
+    {
+	flags_set_v_neg(pep8,pep8->x); //v bit
         pep8->x = flip_bits(pep8->x) + 1;
+        flags_set_nz(pep8,pep8->x); //n and z bits
+    }
 }
 
 /* ************************************************************************* *
@@ -292,31 +262,6 @@ uint16_t flip_bits(uint16_t num)
     return reverse_num;
 }
 
-/* ************************************************************************* *
- * Purpose: Execute the instruction inst                                     *
- *                                                                           *
- * Parameters:                                                               *
- *      pep8: the cpu object used to determine the instruction               *
- *      inst: the instruction to execute                                     *
- *      memory: the bytes of memory that the instruction may use/affect      *
- * ************************************************************************* */
-void execute_load_and_store(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
-{
-    uint8_t mnem = inst->mnem;
-    DEBUGx("mnemonic in load and store: %" PRIu8 "\n",mnem);
-
-    if (mnem == 56 || mnem == 57) //LDA and LDX
-        execute_ldr(pep8,inst,memory);
-    else if (mnem == 58 || mnem == 59) //LDBYTEA and LDBYTEX
-        execute_ldbyter(pep8,inst,memory);
-    else if (mnem == 60 || mnem == 61) //STA and STX
-        execute_str(pep8,inst,memory);
-    else if (mnem == 62 || mnem == 63) //STBYTEA and STBYTEX
-        execute_stbyter(pep8,inst,memory);
-    else
-        printf("execute_load_store error\n");
-}
-
 /* ************************************************************************* *
  * Purpose: Execute the instruction LDr                                      *
  *                                                                           *
@@ -343,14 +288,12 @@ void execute_ldr(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
     if (inst->mnem == 56) //LDA
     {
         pep8->accum = temp;
-        pep8->z = pep8->accum == 0 ? true:false; //set z bit
-        pep8->n = ((pep8->accum>>15) & 1) == 1 ? true:false; //set n bit
+        flags_set_nz(pep8,pep8->accum); //n and z bits
     }
     else //LDX
     {
         pep8->x = temp;
-        pep8->z = pep8->x == 0 ? true:false; //set z bit
-        pep8->n = ((pep8->x>>15) & 1) == 1 ? true:false; //set n bit
+        flags_set_nz(pep8,pep8->x); //n and z bits
     }
 }
 
@@ -376,14 +319,12 @@ void execute_ldbyter(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
     if (inst->mnem == 58) //LDBYTEA
     {
         pep8->accum = temp;
-        pep8->z = pep8->accum == 0 ? true:false; //set z bit
-        pep8->n = ((pep8->accum>>15) & 1) == 1 ? true:false; //set n bit
+        flags_set_nz(pep8,pep8->accum); //n and z bits
     }
     else //LDBYTEX
     {
         pep8->x = temp;
-        pep8->z = pep8->x == 0 ? true:false; //set z bit
-        pep8->n = ((pep8->x>>15) & 1) == 1 ? true:false; //set n bit
+        flags_set_nz(pep8,pep8->x); //n and z bits
     }
 }
 
@@ -397,7 +338,8 @@ void execute_ldbyter(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
  * ************************************************************************* */
 void execute_str(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
 {
-    print_divider(); //cleanlines of output
+    if (pep8->trace == TRACE_FULL)
+	print_divider(); //cleanlines of output
 
     if (inst->addr_mode == 1) //direct
     {
@@ -413,10 +355,9 @@ void execute_str(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
 	    most_sig_byte = (uint8_t)(pep8->x >> 8);
             least_sig_byte = (uint8_t)(pep8->x);
 	}
-	memory[inst->op_spec] = most_sig_byte;
-        memory[inst->op_spec+1] = least_sig_byte;
-        printf("  Mem[%04X] <-- 0x%04X\n",inst->op_spec,most_sig_byte);
-        printf("  MEM[%04X] <-- 0x%04X\n",inst->op_spec+1,least_sig_byte);
+	store_byte(memory,inst->op_spec,most_sig_byte);
+        store_byte(memory,inst->op_spec+1,least_sig_byte);
+	print_word_write(pep8,inst->op_spec,most_sig_byte,least_sig_byte);
     }
     else if (inst->addr_mode == 0) //immediate
 	print_invalid_addr_mode(inst);
@@ -434,22 +375,18 @@ void execute_str(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
  * ************************************************************************* */
 void execute_stbyter(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
 {
-    print_divider(); //this function prints output.  This looks cleaner
+    if (pep8->trace == TRACE_FULL)
+	print_divider(); //this function prints output.  This looks cleaner
 
     if (inst->addr_mode == 1) //direct
     {
+	uint8_t value;
         if (inst->mnem == 62) //STBYTEA
-	{
-            memory[inst->op_spec] = (uint8_t)pep8->accum;
-    	    printf("  Mem[%04X] <-- 0x%04X\n",inst->op_spec,
-					      (uint8_t)pep8->accum);
-	}
+	    value = (uint8_t)pep8->accum;
         else //STBYTEX
-	{
-            memory[inst->op_spec] = (uint8_t)pep8->x;
-   	    printf("  Mem[%04X] <-- 0x%04X\n",inst->op_spec,
-					      (uint8_t)pep8->x);
-	}
+	    value = (uint8_t)pep8->x;
+	store_byte(memory,inst->op_spec,value);
+	print_byte_write(pep8,inst->op_spec,value);
     }
     else if (inst->addr_mode == 0) //immediate
         print_invalid_addr_mode(inst);
@@ -457,23 +394,6 @@ void execute_stbyter(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
         print_unsupported_addr_mode(inst);
 }
 
-/* ************************************************************************* *
- * Purpose: Execute the instruction inst                                     *
- *                                                                           *
- * Parameters:                                                               *
- *      pep8: the cpu object used to determine the instruction               *
- *      inst: the instruction to execute                                     *
- *      memory: the bytes of memory that the instruction may use/affect      *
- * ************************************************************************* */
-void execute_output(cpu_t* pep8, instruction_t* inst, uint8_t* memory)
-{
-    uint8_t op = pep8->inst_reg>>16;
-    if (op >= 0x38 && op <= 0x3F)
-	execute_deco(pep8,inst,memory);
-    else if (op >= 0x50 && op <= 0x57)
-	execute_charo(pep8,inst,memory);
-}
-
 /* ************************************************************************* *
  * Purpose: Execute the instruction DECO                                     *
  *                                                                           *
@@ -484,19 +404,20 @@ void execute_output(cpu_t* pep8, instruction_t* inst, uint8_t* memory)
  * ************************************************************************* */
 void execute_deco(cpu_t* pep8, instruction_t* inst, uint8_t* memory)
 {
-    print_divider();
+    if (pep8->trace == TRACE_FULL)
+	print_divider();
     int16_t result;
     if (inst->addr_mode == 0x00) //immediate
     {
 	result = (int)(inst->op_spec);
-	printf("  Output: %d\n",result);
+	print_decimal_output(pep8,result);
     }
     else if (inst->addr_mode == 0x01) //direct
     {
         uint16_t most_sig_byte = memory[inst->op_spec];
         uint16_t least_sig_byte = memory[inst->op_spec+1];
         result = (most_sig_byte <<8) + least_sig_byte;	
-	printf("  Output: %d\n",result);
+	print_decimal_output(pep8,result);
     }
     else
         print_unsupported_addr_mode(inst);	
@@ -512,56 +433,16 @@ void execute_deco(cpu_t* pep8, instruction_t* inst, uint8_t* memory)
  * ************************************************************************* */
 void execute_charo(cpu_t* pep8, instruction_t* inst, uint8_t* memory)
 {
-    print_divider();
+    if (pep8->trace == TRACE_FULL)
+	print_divider();
     if(inst->addr_mode == 0x00) //immediate
-    {
-	if (isprint((uint8_t)inst->op_spec))
-	    printf("  Output '%c'\n",(uint8_t)inst->op_spec);
-	else
-	    printf("  Output '\\x%02X'\n",(uint8_t)inst->op_spec);
-    }
+	print_character_output(pep8,(uint8_t)inst->op_spec);
     else if (inst->addr_mode == 0x01) //direct
-    {
-        if (isprint(memory[inst->op_spec]))
-            printf("  Output '%c'\n",memory[inst->op_spec]);
-        else
-            printf("  Output '\\x%02X'\n",memory[inst->op_spec]);
-    }	
+	print_character_output(pep8,memory[inst->op_spec]);
     else
 	print_unsupported_addr_mode(inst);
 }
 
-/* ************************************************************************* *
- * Purpose: Execute the instruction inst                                     *
- *                                                                           *
- * Parameters:                                                               *
- *      pep8: the cpu object used to determine the instruction               *
- *      inst: the instruction to execute                                     *
- *      memory: the bytes of memory that the instruction may use/affect      *
- * ************************************************************************* */
-void execute_branches(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
-{
-    uint8_t mnem = inst->mnem;
-    DEBUGx("mnemonic in load and store: %" PRIu8 "\n",mnem);
-
-    if (mnem == 4) //BR
-        execute_br(pep8,inst,memory);
-    else if (mnem == 5) //BRLE
-        execute_brle(pep8,inst,memory);
-    else if (mnem == 6) //BRLT
-        execute_brlt(pep8,inst,memory);
-    else if (mnem == 7) //BREQ
-        execute_breq(pep8,inst,memory);
-    else if (mnem == 8) //BRNE
-        execute_brne(pep8,inst,memory);
-    else if (mnem == 9) //BRGE
-        execute_brge(pep8,inst,memory);
-    else if (mnem == 10) //BRGT
-        execute_brgt(pep8,inst,memory);
-    else
-        printf("execute_load_store error\n");
-}
-
 /* ************************************************************************* *
  * Purpose: Execute the instruction BR                                       *
  *                                                                           *
@@ -588,7 +469,7 @@ void execute_br(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
  * ************************************************************************* */
 void execute_brle(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
 {
-    if (pep8->n || pep8->z)
+    if (flag_n(pep8) || flag_z(pep8))
     {
         if (inst->addr_mode == 0x00) //immediate
             pep8->pc = inst->op_spec;
@@ -607,7 +488,7 @@ void execute_brle(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
  * ************************************************************************* */
 void execute_brlt(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
 {
-    if (pep8->n)
+    if (flag_n(pep8))
     {
         if (inst->addr_mode == 0x00) //immediate
             pep8->pc = inst->op_spec;
@@ -626,7 +507,7 @@ void execute_brlt(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
  * ************************************************************************* */
 void execute_breq(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
 {
-    if (pep8->z)
+    if (flag_z(pep8))
     {
         if (inst->addr_mode == 0x00) //immediate
             pep8->pc = inst->op_spec;
@@ -645,7 +526,7 @@ void execute_breq(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
  * ************************************************************************* */
 void execute_brne(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
 {
-    if (!(pep8->z))
+    if (!flag_z(pep8))
     {
         if (inst->addr_mode == 0x00) //immediate
             pep8->pc = inst->op_spec;
@@ -664,7 +545,7 @@ void execute_brne(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
  * ************************************************************************* */
 void execute_brge(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
 {
-    if (!(pep8->n))
+    if (!flag_n(pep8))
     {
         if (inst->addr_mode == 0x00) //immediate
             pep8->pc = inst->op_spec;
@@ -683,7 +564,7 @@ void execute_brge(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
  * ************************************************************************* */
 void execute_brgt(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
 {
-    if (!(pep8->n) && !(pep8->z))
+    if (!flag_n(pep8) && !flag_z(pep8))
     {
         if (inst->addr_mode == 0x00) //immediate
             pep8->pc = inst->op_spec;
@@ -694,10 +575,27 @@ void execute_brgt(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
 
 /* ************************************************************************* *
  * Purpose: Execute the instruction STOP                                     *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      pep8: the cpu object to halt                                         *
+ *      inst: the instruction to execute                                     *
+ *      memory: the bytes of memory that the instruction may use/affect      *
+ * ************************************************************************* */
+void execute_stop(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
+{
+    pep8->halted = true; //interpret_memory prints the closing divider
+}
+
+/* ************************************************************************* *
+ * Purpose: Handler for every opcode this interpreter does not implement     *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      pep8: the cpu object used to determine the instruction               *
+ *      inst: the instruction to execute                                     *
+ *      memory: the bytes of memory that the instruction may use/affect      *
  * ************************************************************************* */
-void execute_stop()
+void execute_unsupported(cpu_t* pep8,instruction_t* inst,uint8_t* memory)
 {
-    print_divider();
-    exit(0);
+    print_unsupported_instruction(inst);
 }
 
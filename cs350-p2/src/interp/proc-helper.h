@@ -7,9 +7,10 @@
 
 /*Prototypes*/
 uint16_t flip_bits(uint16_t num);
-void execute_stop();
+void execute_stop(cpu_t*,instruction_t*,uint8_t*);
+void execute_unsupported(cpu_t*,instruction_t*,uint8_t*);
 
-void execute_arithmetic_and_logic_operators(cpu_t*,instruction_t*,uint8_t*);
+/* arithmetic and logic operators */
   void execute_addr(cpu_t*,instruction_t*,uint8_t*);
   void execute_subr(cpu_t*,instruction_t*,uint8_t*);
   void execute_andr(cpu_t*,instruction_t*,uint8_t*);
@@ -18,18 +19,18 @@ void execute_arithmetic_and_logic_operators(cpu_t*,instruction_t*,uint8_t*);
   void execute_notr(cpu_t*,instruction_t*,uint8_t*);
   void execute_negr(cpu_t*,instruction_t*,uint8_t*);
   
-void execute_load_and_store(cpu_t*,instruction_t*,uint8_t*);
+/* load and store */
   void execute_ldr(cpu_t*,instruction_t*,uint8_t*);
   void execute_ldbyter(cpu_t*,instruction_t*,uint8_t*);
   void execute_str(cpu_t*,instruction_t*,uint8_t*);
   void execute_stbyter(cpu_t*,instruction_t*,uint8_t*);
 
-void execute_output(cpu_t*,instruction_t*,uint8_t*);
+/* output */
   void execute_deco(cpu_t*,instruction_t*,uint8_t*);
   void execute_charo(cpu_t*,instruction_t*,uint8_t*);
 
 
-void execute_branches(cpu_t*,instruction_t*,uint8_t*);
+/* branches */
   void execute_br(cpu_t*,instruction_t*,uint8_t*);
   void execute_brle(cpu_t*,instruction_t*,uint8_t*);
   void execute_brlt(cpu_t*,instruction_t*,uint8_t*);
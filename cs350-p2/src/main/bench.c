@@ -0,0 +1,171 @@
+/* ************************************************************************* *
+ * bench.c                                                                   *
+ * -------                                                                   *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Benchmark mode (-b N).  Runs the program N times on every      *
+ *            execution engine without the trace and reports the dispatch    *
+ *            cost per guest instruction, so engines can be compared on the  *
+ *            same image.  It also times the disassembler on a full 64 KB    *
+ *            image, serially and on more and more threads (-j).             *
+ * ************************************************************************* */
+
+
+/* ************************************************************************* *
+ * Library includes here.  For documentation of standard C library           *
+ * functions, see the list at:                                               *
+ *   http://pubs.opengroup.org/onlinepubs/009695399/functions/contents.html  *
+ * ************************************************************************* */
+
+#include <stdio.h>              	/* standard I/O */
+#include <stdbool.h>            	/* bool types */
+#include <stdint.h>             	/* uint8_t, uint64_t */
+#include <string.h> 			/* memcpy */
+#include <inttypes.h>           	/* declares PRIu64 */
+#include <unistd.h>			/* sysconf */
+
+#include "bench.h"			/* header file */
+#include "timer.h"			/* timer_now */
+#include "../interp/interp.h"		/* interpret, ENGINES */
+#include "../interp/bus.h"		/* address_space_create */
+#include "../disasm/disasm.h"		/* inst_list_t */
+#include "../disasm/parallel.h"	/* determine_instructions_parallel */
+
+/* ************************************************************************* *
+ * Purpose: Fill an address space with instructions for the disassembler     *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      image: the space to fill                                             *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      Every instruction specifier appears in turn with an operand that     *
+ *      changes as it goes.  The last two bytes are left zero (STOP), so no  *
+ *      operand specifier can run off the end whichever instructions the     *
+ *      disassembler takes as unary.                                         *
+ * ************************************************************************* */
+static void fill_disasm_image(uint8_t* image)
+{
+    opcode_info_t info;
+    int address = 0;
+    uint8_t spec = 0;
+    memset(image,0,ADDRESS_SPACE_SIZE);
+    while (address + 3 <= ADDRESS_SPACE_SIZE - 2)
+    {
+	describe_opcode(spec,&info);
+	image[address] = spec;
+	if (info.unary)
+	    address++;
+	else
+	{
+	    image[address + 1] = address >> 8;
+	    image[address + 2] = address;
+	    address += 3;
+	}
+	spec++;
+    }
+}
+
+/* ************************************************************************* *
+ * Purpose: Time the disassembler on a full 64 KB image                      *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      runs: how many times to disassemble it                               *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      One row per thread count: 1, 2, 4, ... up to the number of online    *
+ *      processors, which is always a row of its own.                        *
+ * ************************************************************************* */
+static void run_disasm_benchmark(unsigned runs)
+{
+    uint8_t* image = address_space_create();
+    inst_list_t instructions;
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned threads = 1;
+    if (image == NULL)
+    {
+	printf("Error No memory allocated");
+	return;
+    }
+    if (processors < 1)
+	processors = 1;
+    if (processors > MAX_DECODE_THREADS)
+	processors = MAX_DECODE_THREADS;
+
+    fill_disasm_image(image);
+    for (threads = 1; threads <= processors; )
+    {
+	double best = 0;
+	size_t count = 0;
+	unsigned run = 0;
+	char name[16];
+	for (run = 0; run < runs; run++)
+	{
+	    double start = timer_now();
+	    determine_instructions_parallel(&instructions,image,
+					    ADDRESS_SPACE_SIZE,NULL,threads);
+	    double seconds = timer_now() - start;
+	    count = instructions.count;
+	    inst_list_free(&instructions);
+	    if (run == 0 || seconds < best)
+		best = seconds;
+	}
+	snprintf(name,sizeof(name),"disasm/%u",threads);
+	printf("%-10s %6u %14zu %14.6f %14.2f\n",name,runs,count,best,
+	       count > 0 ? best * 1e9 / count : 0.0);
+
+	if (threads == processors)
+	    break;
+	threads = 2 * threads < processors ? 2 * threads : processors;
+    }
+
+    address_space_free(image);
+}
+
+/* ************************************************************************* *
+ * Purpose: Time every engine on the program in memory                       *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      memory: the address space with the program loaded; never modified    *
+ *      entry: where the program starts                                      *
+ *      runs: how many times to run the program on each engine               *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      Each run gets a fresh copy of the space so a program that stores     *
+ *      into itself behaves the same every time.  The best run is reported,  *
+ *      which keeps one-off scheduling noise out of the comparison.  The     *
+ *      disassembler row counts listed instructions instead of steps.        *
+ * ************************************************************************* */
+void run_benchmark(uint8_t* memory,uint16_t entry,unsigned runs)
+{
+    uint8_t* image = address_space_create();
+    if (image == NULL)
+    {
+	printf("Error No memory allocated");
+	return;
+    }
+
+    printf("%-10s %6s %14s %14s %14s\n","Engine","Runs","Instructions",
+	   "Best time (s)","ns/instruction");
+    int engine = 0;
+    for (engine = 0; engine < NUMBER_OF_ENGINES; engine++)
+    {
+	double best = 0;
+	interp_stats_t stats = {0};
+	unsigned run = 0;
+	for (run = 0; run < runs; run++)
+	{
+	    cpu_t pep8;
+	    memcpy(image,memory,ADDRESS_SPACE_SIZE);
+	    double start = timer_now();
+	    interpret(engine,image,&pep8,entry,TRACE_NONE,&stats);
+	    double seconds = timer_now() - start;
+	    if (run == 0 || seconds < best)
+		best = seconds;
+	}
+	printf("%-10s %6u %14" PRIu64 " %14.6f %14.2f\n",ENGINES[engine],
+	       runs,stats.steps,best,
+	       stats.steps > 0 ? best * 1e9 / stats.steps : 0.0);
+    }
+    run_disasm_benchmark(runs);
+
+    address_space_free(image);
+}
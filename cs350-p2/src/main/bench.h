@@ -0,0 +1,14 @@
+#ifndef __BENCH__
+#define __BENCH__
+
+/* ************************************************************************* *
+ * bench.h                                                                   *
+ * -------                                                                   *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Header file for bench.c                                        *
+ * ************************************************************************* */
+
+/* Prototypes */
+void run_benchmark(uint8_t*,uint16_t,unsigned);
+
+#endif
@@ -0,0 +1,119 @@
+/* ************************************************************************* *
+ * hex-object.c                                                              *
+ * ------------                                                              *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Reads the text object files the Pep/8 assembler writes:        *
+ *            pairs of hex digits separated by white space and ended by      *
+ *            "zz", for example                                              *
+ *                                                                           *
+ *              C1 00 11 71 00 13 A1 00 15 F1 00 10 51 00 10 00              *
+ *              00 00 05 00 03 00 30 zz                                      *
+ *                                                                           *
+ *            so they can be loaded without converting them to binary        *
+ *            first.                                                         *
+ * ************************************************************************* */
+
+
+/* ************************************************************************* *
+ * Library includes here.                                                    *
+ * ************************************************************************* */
+
+#include <stdint.h>             /* uint8_t */
+#include <stddef.h>             /* size_t */
+#include <stdbool.h>            /* bool types */
+
+#include "hex-object.h"		/* header file */
+
+/* ************************************************************************* *
+ * Global variable declarations                                              *
+ * ************************************************************************* */
+#define NOT_HEX 0x10 //HEX_VALUES entry for a character that is not a digit
+#define SPACE   0x20 //HEX_VALUES entry for white space
+
+/* The value of each hex digit, upper or lower case; SPACE for white space
+ * and NOT_HEX for everything else, so one lookup classifies a character */
+static uint8_t HEX_VALUES[256];
+static _Bool have_hex_values = false;
+
+/* ************************************************************************* *
+ * Purpose: Fill in HEX_VALUES before the first decode                       *
+ * ************************************************************************* */
+static void make_hex_values()
+{
+    int c = 0;
+    for (c = 0; c < 256; c++)
+	HEX_VALUES[c] = NOT_HEX;
+    for (c = 0; c < 10; c++)
+	HEX_VALUES['0' + c] = c;
+    for (c = 0; c < 6; c++)
+    {
+	HEX_VALUES['A' + c] = 10 + c;
+	HEX_VALUES['a' + c] = 10 + c;
+    }
+    HEX_VALUES[' '] = SPACE;
+    HEX_VALUES['\t'] = SPACE;
+    HEX_VALUES['\n'] = SPACE;
+    HEX_VALUES['\r'] = SPACE;
+    have_hex_values = true;
+}
+
+/* ************************************************************************* *
+ * hex_object_decode -- decodes a Pep/8 text object file                     *
+ *                                                                           *
+ * Parameters                                                                *
+ *   text -- the file's contents                                             *
+ *   length -- its length                                                    *
+ *   image -- receives the bytes                                             *
+ *   capacity -- how many bytes image has room for                           *
+ *                                                                           *
+ * Returns                                                                   *
+ *   the number of bytes in the object, or HEX_NOT_OBJECT if the text is     *
+ *   not one: anything but pairs of hex digits between white space, or no    *
+ *   "zz", or something other than white space after it                      *
+ *                                                                           *
+ * Notes                                                                     *
+ *   Only the first capacity bytes are stored, but the whole text is still   *
+ *   checked and counted, so a caller can tell an object that is too big     *
+ *   from a binary file.  A binary image only reads as an object if it is    *
+ *   made of nothing but hex pairs, white space and a final "zz".            *
+ * ************************************************************************* */
+long hex_object_decode(const uint8_t* text,size_t length,uint8_t* image,
+		       size_t capacity)
+{
+    const uint8_t* at = text;
+    const uint8_t* end = text + length;
+    size_t count = 0;
+    if (!have_hex_values)
+	make_hex_values();
+
+    while (at < end)
+    {
+	uint8_t high = HEX_VALUES[at[0]];
+	if (high == SPACE)
+	{
+	    at++;
+	    continue;
+	}
+	if (end - at < 2)
+	    return HEX_NOT_OBJECT;
+	if (at[0] == 'z' && at[1] == 'z')
+	{
+	    for (at += 2; at < end; at++) //only white space may follow
+	    {
+		if (HEX_VALUES[*at] != SPACE)
+		    return HEX_NOT_OBJECT;
+	    }
+	    return count;
+	}
+	uint8_t low = HEX_VALUES[at[1]];
+	if ((high | low) & (NOT_HEX | SPACE)) //either one not a digit
+	    return HEX_NOT_OBJECT;
+	if (end - at > 2 && HEX_VALUES[at[2]] != SPACE) //pairs stand alone
+	    return HEX_NOT_OBJECT;
+	if (count < capacity)
+	    image[count] = (high << 4) | low;
+	count++;
+	at += 2;
+    }
+    return HEX_NOT_OBJECT; //no "zz"
+}
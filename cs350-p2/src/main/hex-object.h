@@ -0,0 +1,20 @@
+#ifndef __HEX_OBJECT__
+#define __HEX_OBJECT__
+
+/* ************************************************************************* *
+ * hex-object.h                                                              *
+ * ------------                                                              *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Header file for hex-object.c                                   *
+ * ************************************************************************* */
+
+#include <stdint.h>		/* uint8_t */
+#include <stddef.h>		/* size_t */
+
+/* hex_object_decode's answer for text that is not a Pep/8 object file */
+#define HEX_NOT_OBJECT -1
+
+/* Prototypes */
+long hex_object_decode(const uint8_t*,size_t,uint8_t*,size_t);
+
+#endif
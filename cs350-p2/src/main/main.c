@@ -17,20 +17,41 @@
 #include <stdint.h>             	/* uint32_t, uint8_t, and similar types */
 #include <stdlib.h> 			/* malloc */
 #include <inttypes.h>           	/* declares PRIu8 */
+#include <string.h>			/* memcpy */
+#include <fcntl.h>			/* open */
+#include <unistd.h>			/* close */
+#include <sys/stat.h>			/* fstat */
+#include <sys/mman.h>			/* mmap */
 
 #include "../cmdline/parse.h"   	/* command line parser */
 #include "debug.h"			/* DEBUG statements */
 #include "../disasm/disasm.h"		/* Disassembler */
+#include "../disasm/parallel.h"	/* determine_instructions_parallel */
+#include "../disasm/flow.h"		/* discover_symbols */
+#include "../disasm/stream.h"		/* disassemble_stream */
+#include "../disasm/result-cache.h"	/* result_cache_load */
+#include "../disasm/xref.h"		/* xref_build */
 #include "../symbol/sym.h"		/* Symbols */
 #include "../output/print-disasm.h"	/* Dissasembler Output */
+#include "../output/print-records.h"	/* print_json, print_packed */
 #include "../interp/interp.h"		/* Interpreter */
+#include "../interp/bus.h"		/* address_space_create */
+#include "../interp/cache.h"		/* cache_set_program */
+#include "timer.h"			/* timer_now */
+#include "hex-object.h"			/* hex_object_decode */
+#include "package.h"			/* package_open */
+#include "bench.h"			/* run_benchmark */
+#include "../output/trace.h"		/* binary trace */
+#include "../output/emit-c.h"		/* emit_c */
 
 /* ************************************************************************* *
  * Local function declarations                                               *
  * ************************************************************************* */
-int file_open_and_read(const char *,uint8_t** array,int*); 
+int file_open_and_read(const char *,uint16_t,uint8_t** array,int*,
+		       package_t*);
 void print_decimal(uint8_t *array,int file_length);
-int validate_instructions(instruction_t*, symtab_t*);
+void print_interpreter_stats(interp_stats_t* stats,double seconds);
+int validate_instructions(inst_list_t*, symtab_t*);
 
 /* ************************************************************************* *
  * Purpose: Print out the given contents in decimal form.                    *
@@ -53,32 +74,78 @@ void print_decimal(uint8_t *array,int file_length)
     printf("\n");
 }
 
+/* ************************************************************************* *
+ * Purpose: Report how fast the interpreter ran (-t).  Goes to stderr so the *
+ *          trace on stdout is unchanged.                                    *
+ *                                                                           *
+ * Parameters:                                                               *
+ *   stats -- the counters the interpreter filled in                         *
+ *   seconds -- the wall time the interpreter took                           *
+ * ************************************************************************* */
+void print_interpreter_stats(interp_stats_t* stats,double seconds)
+{
+    fprintf(stderr,"Instructions executed       %" PRIu64 "\n",stats->steps);
+    fprintf(stderr,"Interpreter time            %.6f s\n",seconds);
+    if (seconds > 0)
+	fprintf(stderr,"Instructions per second     %.0f\n",
+		stats->steps / seconds);
+    fprintf(stderr,"Decode cache hits           %" PRIu64 "\n",
+	    stats->cache_hits);
+    fprintf(stderr,"Decode cache misses         %" PRIu64 "\n",
+	    stats->cache_misses);
+    fprintf(stderr,"Decode cache invalidations  %" PRIu64 "\n",
+	    stats->cache_invalidations);
+}
+
+/* ************************************************************************* *
+ * run_interpreter -- runs the program on the engine and trace level the     *
+ *                    options ask for                                        *
+ *                                                                           *
+ * Parameters                                                                *
+ *   memory -- the address space with the program loaded                     *
+ *   options -- the parsed command line                                      *
+ *                                                                           *
+ * Returns                                                                   *
+ *    0 - if success                                                         *
+ *    1 - if failure                                                         *
+ * ************************************************************************* */
+int run_interpreter(uint8_t* memory,options_t* options)
+{
+    cpu_t pep8;
+    interp_stats_t stats;
+    if (options->trace_file != NULL && trace_open(options->trace_file))
+	return 1;
+    double start = timer_now();
+    interpret(options->engine,memory,&pep8,options->entry,options->trace,
+	      &stats);
+    trace_close();
+    fflush(stdout); //program output comes before the stats on a terminal
+    if (options->stats)
+	print_interpreter_stats(&stats,timer_now() - start);
+    return 0;
+}
+
 /* ************************************************************************* *
  * validate instrutions -- checks to make sure the instruction list is valid *
  *                                                                           *
  * Parameters                                                                *
- *   inst -- the list of instruction objects to check                        *
+ *   instructions -- the list of instruction objects to check                *
  *   symtab -- the table of symbols (if there is any) for the instructions   *
  *                                                                           *
  * Returns                                                                   *
  *    0 - if success                                                         *
  *    1 - if failure                                                         *
  * ************************************************************************* */
-int validate_instructions(instruction_t* inst,symtab_t* symtab)
+int validate_instructions(inst_list_t* instructions,symtab_t* symtab)
 {
     //check for the lack of a STOP instruction
     bool stop_present = false;
-    instruction_t* cur_inst = inst;
-    while (cur_inst->next != NULL)
+    size_t i = 0;
+    for (i = 0; i < instructions->count; i++)
     {
-	if (cur_inst->mnem == 0) //STOP
+	if (instructions->items[i].mnem == 0) //STOP
 	    stop_present = true;
-        cur_inst = cur_inst->next;
     }
-    
-    //check one more time after loop
-    if (cur_inst->mnem == 0) //STOP
-        stop_present = true;
 
     if (!stop_present) //no STOP instruction
     {
@@ -91,51 +158,110 @@ int validate_instructions(instruction_t* inst,symtab_t* symtab)
 }
 
 /* ************************************************************************* *
- * file_open_and_read -- opens and reads the file into an array              *
+ * file_open_and_read -- opens and reads the file into a new address space   *
  *                                                                           *
  * Parameters                                                                *
  *   filename -- the name of the file to open to read                        *
- *   array -- the array to read all of the data into                         *
+ *   origin -- the address the first byte of the file is loaded at           *
+ *   array -- receives the address space (see address_space_create)          *
  *   file_length -- the number of elements in the file                       *
+ *   package -- receives the parts of the file if it is a package (see       *
+ *              package.h); package->code stays NULL if it is not            *
  *                                                                           *
- * Returns  								     *
- *    0 - if success 							     *
- *    1 - if failure 							     *
+ * Returns                                                                   *
+ *    0 - if success                                                         *
+ *    1 - if failure                                                         *
+ *                                                                           *
+ * Notes                                                                     *
+ *   The file is mapped rather than read through stdio.  A package's code    *
+ *   is loaded at the package's own origin, not the one given.  A Pep/8      *
+ *   text object ("C1 00 11 ... zz", see hex-object.c) is decoded from the   *
+ *   mapping straight into the address space; anything else is a binary      *
+ *   image and is copied there once.  That copy is the only one: the         *
+ *   address space is a mirrored mapping of its own that the program may     *
+ *   write to, so the file's pages cannot stand in for it.  A package stays  *
+ *   mapped for the rest of the run, because package_symbols makes its       *
+ *   symbol table out of the mapped records and labels.                      *
  * ************************************************************************* */
-int file_open_and_read(const char *filename, uint8_t** array,int* file_length)
+int file_open_and_read(const char *filename,uint16_t origin,uint8_t** array,
+		       int* file_length,package_t* package)
 {
-    FILE *fp;
+    struct stat st;
     DEBUGx("Opening file \"%s\"\n",filename);
-    fp = fopen(filename, "r");
+    int fd = open(filename,O_RDONLY);
 
-    if (fp == NULL)
+    if (fd < 0)
     {
         printf("File \"%s\" does not exist\n",filename);
         return 1;
     }
-    if (fseek(fp, 0, SEEK_END) != 0) /* check if seek is successful */
+    if (fstat(fd,&st) != 0 || !S_ISREG(st.st_mode)) /* a file we can map */
     {
         printf("Error with File\n");
+        close(fd);
         return 1;
     }
-    *file_length = ftell(fp);
-    if (*file_length == 0)
+    if (st.st_size == 0)
     {
         printf("Error File Empty\n");
+        close(fd);
+        return 1;
+    }
+    uint8_t* contents = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if (contents == MAP_FAILED)
+    {
+        printf("Error with File\n");
         return 1;
     }
 
-    DEBUGx("File contains %d bytes of data\n", *file_length);
-    fseek(fp,0,SEEK_SET);
-    *array = malloc(*file_length * sizeof(uint8_t));
+    int packaged = package_open(contents,st.st_size,package);
+    if (packaged == 1)
+    {
+        printf("\"%s\" is a damaged package\n",filename);
+        munmap(contents,st.st_size);
+        return 1;
+    }
+    *array = address_space_create();
     if (*array == NULL)
     {
         printf("Error No memory allocated");
+        munmap(contents,st.st_size);
         return 1;
     }
 
-    fread(*array,sizeof(uint8_t),*file_length,fp);
-    fclose(fp);
+    //a package's code and a binary image are copied once; a text object
+    //decodes into place
+    long length = 0;
+    if (packaged == 0)
+    {
+        origin = package->origin;
+        length = package->code_length;
+    }
+    size_t room = ADDRESS_SPACE_SIZE - origin;
+    if (packaged == 0)
+        memcpy(*array + origin,package->code,length <= (long)room ? length : 0);
+    else if ((length = hex_object_decode(contents,st.st_size,*array + origin,
+                                         room)) == HEX_NOT_OBJECT)
+    {
+        length = st.st_size;
+        memcpy(*array + origin,contents,length <= (long)room ? length : 0);
+    }
+    if (packaged != 0)
+        munmap(contents,st.st_size);
+    DEBUGx("File contains %ld bytes of data\n", length);
+
+    if (length == 0)
+    {
+        printf("Error File Empty\n");
+        return 1;
+    }
+    if (length > (long)room)
+    {
+        printf("The program does not fit in memory at 0x%04X\n",origin);
+        return 1;
+    }
+    *file_length = length;
     return 0;
 }
 
@@ -159,55 +285,202 @@ int file_open_and_read(const char *filename, uint8_t** array,int* file_length)
 int
 main (int argc, char **argv)
 {
-    //create variables to pass by reference
-    const char* filename = NULL;
-    const char* symlist = NULL;
-    _Bool interpret = false;
+    //create options to pass by reference
+    options_t options = {0};
     
     //parse the command line.  Returns 1 if error
-    if (parse_command_line (argc, argv,&filename,&symlist,&interpret) == 1)
+    if (parse_command_line (argc, argv,&options) == 1)
 	return 1;
+    const char* filename = options.filename;
+    const char* symlist = options.symlist;
+
+    //-d: the file is a binary trace, not a program
+    if (options.decode)
+	return trace_decode(filename);
+
+    //-p: list the file as it is read instead of loading it
+    if (options.stream)
+	return disassemble_stream(filename,options.origin);
 
-    //create array to store the contents of file
+    //create the address space the file is loaded into
     uint8_t *memory = NULL;
     int mem_length = 0;
     
-    //open and read file.  Adjusts length of memory and contents of memory.
-    //returns 1 (i.e. True) if error
-    if (file_open_and_read(filename,&memory,&mem_length))
+    //open and read file.  Sets the length of the program and loads it at
+    //the origin.  returns 1 (i.e. True) if error
+    package_t package = {0};
+    if (file_open_and_read(filename,options.origin,&memory,&mem_length,
+			   &package))
 	return 1;
 
-    //create symbol table to store symbols
+    //a package says where it was loaded and where it starts, and carries
+    //its own symbols; -g still picks the start
+    if (package.code != NULL)
+    {
+	if (symlist != NULL || options.recursive)
+	{
+	    printf("A package has its symbols; -s and -r cannot be used\n");
+	    return 1;
+	}
+	options.origin = package.origin;
+	if (!options.has_entry)
+	    options.entry = package.entry;
+    }
+    else if (!options.has_entry)
+	options.entry = options.origin;
+    uint8_t* image = memory + options.origin; //what the listing works on
+
+    //create symbol table to store symbols, and its index by address
     symtab_t* symtab = NULL;
+    symtab_index_t* symbols = NULL;
+    //Create instruction list to pass by reference
+    inst_list_t instructions;
+
+    //-C: a cached disassembly of the same image and symlist replaces
+    //reading the symlist and decoding.  A package is its own symlist.
+    result_cache_t cache = {0};
+    bool cached = false;
+    if (options.cache_dir != NULL)
+    {
+	if (result_cache_open(&cache,options.cache_dir,image,mem_length,
+			      options.origin,
+			      package.code != NULL ? filename : symlist,
+			      options.recursive))
+	    return 1;
+	cached = result_cache_load(&cache,&symtab,&symbols,&instructions);
+    }
+    double start = timer_now(); //of the work a cache hit saves
 
     //check for symlist file and read it
-    if (symlist != NULL)
+    if (symlist != NULL && !cached)
     {
 	//returns 1 (i.e. True) if error
-        if (symlist_open_and_read(symlist,&symtab))
+        if (symlist_open_and_read(symlist,&symtab,&symbols))
+	    return 1;
+    }
+    else if (package.code != NULL && !cached)
+    {
+	if (package_symbols(&package,&symtab,&symbols))
+	    return 1;
+    }
+
+    //benchmark mode replaces the listing and the trace
+    if (options.bench_runs > 0)
+    {
+	run_benchmark(memory,options.entry,options.bench_runs);
+	address_space_free (memory);
+	memory = NULL;
+	return 0;
+    }
+
+    //headless runs go straight to the interpreter
+    if (options.headless)
+    {
+	int status = run_interpreter(memory,&options);
+	address_space_free (memory);
+	memory = NULL;
+	return status;
+    }
+
+    //-r: make the symbol table up by following the program instead
+    if (options.recursive && !cached)
+    {
+	if (discover_symbols(image,mem_length,options.origin,&symtab))
 	    return 1;
+	if ((symbols = symtab_index_build(symtab)) == NULL)
+	{
+	    printf("Error No memory allocated");
+	    return 1;
+	}
+    }
+
+    //-k: package the program and its symbols instead of listing
+    if (options.package_file != NULL)
+    {
+	int status = package_write(options.package_file,image,mem_length,
+				   options.origin,options.entry,symtab,
+				   symbols);
+	symtab_index_free (symbols);
+	address_space_free (memory);
+	memory = NULL;
+	return status;
     }
 
-    //Create instruction to pass by reference
-    instruction_t* instructions;
     //Determine the instructions in the array and create list of instructions
-    determine_instructions(&instructions,memory,mem_length,&symtab);    
-    
+    if (!cached)
+    {
+	determine_instructions_parallel(&instructions,image,mem_length,
+					symbols,options.decode_threads);
+	result_cache_store(&cache,symtab,symbols,&instructions,
+			   timer_now() - start);
+    }
+    if (options.stats)
+	result_cache_print_stats(&cache);
+    result_cache_close(&cache);
+
     //Make sure instructions are valid
-    if (validate_instructions(instructions,symtab))
+    if (validate_instructions(&instructions,symtab))
 	return 1;
 
-    //Print out the disassembler
-    print_disassembler(instructions,memory,&symtab);
+    //-c: translate to C instead of listing
+    if (options.c_file != NULL)
+    {
+	int status = emit_c(options.c_file,filename,&instructions,symtab,
+			    memory,mem_length,options.origin,options.entry);
+	inst_list_free (&instructions);
+	address_space_free (memory);
+	memory = NULL;
+	return status;
+    }
+
+    //-x: list what refers to one address instead of listing
+    if (options.xref != NULL)
+    {
+	uint16_t target = 0;
+	xref_t* xref = NULL;
+	if (xref_find_target(options.xref,symtab,&target))
+	{
+	    printf("\"%s\" is not a label or an address\n",options.xref);
+	    return 1;
+	}
+	if ((xref = xref_build(&instructions,symbols)) == NULL)
+	{
+	    printf("Error No memory allocated");
+	    return 1;
+	}
+	print_xref(xref,&instructions,image,symbols,target);
+	xref_free(xref);
+	inst_list_free (&instructions);
+	symtab_index_free (symbols);
+	address_space_free (memory);
+	memory = NULL;
+	return 0;
+    }
 
-    if (interpret)
+    //Print out the disassembler, as text or as records (-f)
+    int status = 0;
+    if (options.format == FORMAT_JSON)
+	print_json(&instructions,image,mem_length,symbols);
+    else if (options.format == FORMAT_PACKED)
+	status = print_packed(&instructions,image,mem_length,options.origin,
+			      symbols);
+    else
+	print_disassembler(&instructions,image,symbols);
+    symtab_index_free (symbols);
+    if (status)
+	return 1;
+
+    //the interpreter starts with the listing's instructions already decoded
+    if (options.interpret)
     {
-	cpu_t pep8;
-	interpret_memory(memory,&pep8,mem_length);
+	cache_set_program(&instructions,options.origin);
+	if (run_interpreter(memory,&options))
+	    return 1;
     }
+    inst_list_free (&instructions);
 	
     //free memory and set it to NULL before exiting
-    free (memory);
+    address_space_free (memory);
     memory = NULL;
     return 0;
 }
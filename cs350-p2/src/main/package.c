@@ -0,0 +1,275 @@
+/* ************************************************************************* *
+ * package.c                                                                 *
+ * ---------                                                                 *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Packages (-k): one file holding a program's code, where it is  *
+ *            loaded and started, and its symbol table already indexed by    *
+ *            address (layout in package.h).  A package is mapped and used   *
+ *            in place: the code is copied into the address space once, and  *
+ *            the symbol table's records and string pool are the mapping's   *
+ *            own pages, so loading one is checking it and filling the       *
+ *            index, with no symlist parse and no copy.                      *
+ * ************************************************************************* */
+
+
+/* ************************************************************************* *
+ * Library includes here.                                                    *
+ * ************************************************************************* */
+
+#include <stdio.h>              /* standard I/O */
+#include <stdint.h>             /* uint8_t, uint32_t */
+#include <stdlib.h>		/* calloc, free */
+#include <string.h>		/* memcmp, memcpy, memset */
+
+#include "package.h"		/* header file */
+
+/* ************************************************************************* *
+ * Global variable declarations                                              *
+ * ************************************************************************* */
+#define ALIGN8(n) (((n) + 7) & ~(size_t)7)
+
+//the records are symbol_t's own bytes
+_Static_assert(sizeof(symbol_t) == PACKAGE_SYMBOL_SIZE,
+	       "a package symbol record is a symbol_t");
+
+/* ************************************************************************* *
+ * Little-endian field helpers, as in trace.c                                *
+ * ************************************************************************* */
+static void put16(uint8_t* at,uint16_t value)
+{
+    at[0] = value;
+    at[1] = value >> 8;
+}
+
+static void put32(uint8_t* at,uint32_t value)
+{
+    put16(at,value);
+    put16(at + 2,value >> 16);
+}
+
+static uint16_t get16(const uint8_t* at)
+{
+    return at[0] | (at[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* at)
+{
+    return get16(at) | ((uint32_t)get16(at + 2) << 16);
+}
+
+/* ************************************************************************* *
+ * package_open -- finds the parts of a package                              *
+ *                                                                           *
+ * Parameters                                                                *
+ *   contents -- the file's contents                                         *
+ *   length -- its length                                                    *
+ *   package -- receives pointers to the parts, into contents                *
+ *                                                                           *
+ * Returns                                                                   *
+ *    0 - if success                                                         *
+ *    1 - if the file is a package whose sizes do not add up                 *
+ *    PACKAGE_NOT_PACKAGE - if the file does not start with PACKAGE_MAGIC    *
+ *                                                                           *
+ * Notes                                                                     *
+ *    Only the layout is checked here; the symbol records are checked by     *
+ *    package_symbols.  contents must stay mapped while the package or its   *
+ *    symbols are used.                                                      *
+ * ************************************************************************* */
+int package_open(const uint8_t* contents,size_t length,package_t* package)
+{
+    if (length < PACKAGE_HEADER_SIZE ||
+	memcmp(contents,PACKAGE_MAGIC,PACKAGE_MAGIC_SIZE) != 0)
+	return PACKAGE_NOT_PACKAGE;
+
+    uint32_t code_length = get32(contents + 12);
+    uint32_t symbol_count = get32(contents + 16);
+    uint32_t index_count = get32(contents + 20);
+    uint32_t strings_length = get32(contents + 24);
+    size_t symbols = ALIGN8(PACKAGE_HEADER_SIZE + (size_t)code_length);
+    size_t index = symbols + (size_t)symbol_count * PACKAGE_SYMBOL_SIZE;
+    size_t strings = index + (size_t)index_count * sizeof(uint32_t);
+    if (index_count > symbol_count || strings + strings_length != length ||
+	(symbol_count > 0 && (strings_length == 0 || contents[strings] != '\0' ||
+			      contents[length - 1] != '\0')))
+	return 1;
+
+    package->code = contents + PACKAGE_HEADER_SIZE;
+    package->code_length = code_length;
+    package->origin = get16(contents + 8);
+    package->entry = get16(contents + 10);
+    package->symbols = (const symbol_t*)(contents + symbols);
+    package->symbol_count = symbol_count;
+    package->index = contents + index;
+    package->index_count = index_count;
+    package->strings = (const char*)contents + strings;
+    package->strings_length = strings_length;
+    return 0;
+}
+
+/* ************************************************************************* *
+ * package_symbols -- makes the symbol table a package carries               *
+ *                                                                           *
+ * Parameters                                                                *
+ *   package -- from package_open                                            *
+ *   symtab -- receives the symbol list, as symlist_open_and_read gives it,  *
+ *             or NULL if the package has no symbols                         *
+ *   symbols -- receives its index by address, NULL along with symtab        *
+ *                                                                           *
+ * Returns                                                                   *
+ *    0 - if success                                                         *
+ *    1 - if failure                                                         *
+ *                                                                           *
+ * Notes                                                                     *
+ *    The table's symbols and strings are the package's records and pool,    *
+ *    where they are mapped; only the symtab_t and the index are allocated.  *
+ *    So the mapping must outlive the table, and the table is not freed      *
+ *    with symtab_free.  The index is filled from the package's index        *
+ *    instead of by symtab_index_build; it was written from one, so the      *
+ *    same symbol wins at a shared offset.                                   *
+ * ************************************************************************* */
+int package_symbols(const package_t* package,symtab_t** symtab,
+		    symtab_index_t** symbols)
+{
+    uint32_t count = package->symbol_count;
+    uint32_t i = 0;
+    long last = -1; //the index's addresses only go up
+    *symtab = NULL;
+    *symbols = NULL;
+    if (count == 0)
+	return 0;
+
+    symtab_t* table = calloc(1,sizeof(symtab_t));
+    symtab_index_t* index = calloc(1,sizeof(symtab_index_t));
+    if (table == NULL || index == NULL)
+    {
+	printf("Error No memory allocated");
+	free(table);
+	free(index);
+	return 1;
+    }
+    //nothing writes to a table once it is indexed, so the read-only
+    //mapping can hold it
+    table->symbols = (symbol_t*)package->symbols;
+    table->strings = (char*)package->strings;
+    table->count = table->capacity = count;
+    table->strings_length = table->strings_capacity =
+	package->strings_length;
+    index->symtab = table;
+
+    for (i = 0; i < count; i++)
+    {
+	const symbol_t* symbol = &package->symbols[i];
+	if (symbol->label >= package->strings_length ||
+	    symbol->type >= NUMBER_OF_SYMTYPES ||
+	    (symbol->type != BLOCK && symbol->block_length != 0))
+	    break;
+    }
+    if (i == count)
+    {
+	for (i = 0; i < package->index_count; i++)
+	{
+	    uint32_t number = get32(package->index + i * sizeof(uint32_t));
+	    if (number >= count || table->symbols[number].offset <= last)
+		break;
+	    last = table->symbols[number].offset;
+	    index->at[last] = &table->symbols[number];
+	}
+	if (i == package->index_count)
+	{
+	    *symtab = table;
+	    *symbols = index;
+	    return 0;
+	}
+    }
+    printf("The package's symbols are damaged\n");
+    free(table);
+    free(index);
+    return 1;
+}
+
+/* ************************************************************************* *
+ * package_write -- writes a program and its symbols as one package          *
+ *                                                                           *
+ * Parameters                                                                *
+ *   filename -- the package to create                                       *
+ *   code -- the program's bytes                                             *
+ *   length -- how many there are                                            *
+ *   origin -- where they are loaded                                         *
+ *   entry -- where the interpreter starts                                   *
+ *   symtab -- the symbol table, NULL if there is none                       *
+ *   symbols -- its index by address                                         *
+ *                                                                           *
+ * Returns                                                                   *
+ *    0 - if success                                                         *
+ *    1 - if failure                                                         *
+ * ************************************************************************* */
+int package_write(const char* filename,const uint8_t* code,uint32_t length,
+		  uint16_t origin,uint16_t entry,symtab_t* symtab,
+		  const symtab_index_t* symbols)
+{
+    static const uint8_t zeros[8] = {0};
+    uint8_t header[PACKAGE_HEADER_SIZE] = {0};
+    uint8_t field[sizeof(uint32_t)];
+    uint32_t count = symtab != NULL ? symtab->count : 0;
+    uint32_t index_count = 0;
+    uint32_t strings_length = 0;
+    uint32_t address = 0;
+    uint32_t i = 0;
+
+    if (symtab != NULL)
+	strings_length = symtab->strings_length;
+    for (address = 0; address < SYMTAB_INDEX_SIZE; address++)
+    {
+	if (symtab_lookup(symbols,address) != NULL)
+	    index_count++;
+    }
+
+    FILE* fp = fopen(filename,"wb");
+    if (fp == NULL)
+    {
+	printf("Cannot create package \"%s\"\n",filename);
+	return 1;
+    }
+
+    memcpy(header,PACKAGE_MAGIC,PACKAGE_MAGIC_SIZE);
+    put16(header + 8,origin);
+    put16(header + 10,entry);
+    put32(header + 12,length);
+    put32(header + 16,count);
+    put32(header + 20,index_count);
+    put32(header + 24,strings_length);
+    fwrite(header,1,PACKAGE_HEADER_SIZE,fp);
+    fwrite(code,1,length,fp);
+    fwrite(zeros,1,ALIGN8(PACKAGE_HEADER_SIZE + (size_t)length) -
+	   (PACKAGE_HEADER_SIZE + length),fp);
+
+    for (i = 0; i < count; i++)
+    {
+	symbol_t record;
+	memset(&record,0,sizeof(record)); //no stray padding in the file
+	record.label = symtab->symbols[i].label;
+	record.offset = symtab->symbols[i].offset;
+	record.block_length = symtab->symbols[i].type == BLOCK ?
+	    symtab->symbols[i].block_length : 0;
+	record.type = symtab->symbols[i].type;
+	fwrite(&record,1,PACKAGE_SYMBOL_SIZE,fp);
+    }
+    for (address = 0; address < SYMTAB_INDEX_SIZE; address++)
+    {
+	const symbol_t* symbol = symtab_lookup(symbols,address);
+	if (symbol != NULL)
+	{
+	    put32(field,symbol - symtab->symbols);
+	    fwrite(field,1,sizeof(uint32_t),fp);
+	}
+    }
+    if (strings_length > 0)
+	fwrite(symtab->strings,1,strings_length,fp);
+
+    if (ferror(fp) | fclose(fp))
+    {
+	printf("Cannot write package \"%s\"\n",filename);
+	return 1;
+    }
+    return 0;
+}
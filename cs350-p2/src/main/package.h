@@ -0,0 +1,68 @@
+#ifndef __PACKAGE__
+#define __PACKAGE__
+
+/* ************************************************************************* *
+ * package.h                                                                 *
+ * ---------                                                                 *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Header file for package.c                                      *
+ * ************************************************************************* */
+
+#include <stdint.h>		/* uint8_t, uint32_t */
+#include <stddef.h>		/* size_t */
+
+#include "../disasm/disasm.h"	/* symtab_t, symtab_index_t */
+
+/* ************************************************************************* *
+ * Package layout (all fields little-endian):                                *
+ *   header, PACKAGE_HEADER_SIZE bytes:                                      *
+ *      0  8    the bytes "PEP8PKG2"                                         *
+ *      8  u16  origin: where the code is loaded                             *
+ *     10  u16  entry: where the interpreter starts                          *
+ *     12  u32  code length                                                  *
+ *     16  u32  number of symbols                                            *
+ *     20  u32  number of index entries                                      *
+ *     24  u32  string pool length                                           *
+ *     28  u32  zero                                                         *
+ *   then the code, then zeros up to a multiple of 8, then one               *
+ *   PACKAGE_SYMBOL_SIZE record per symbol, in symbol list order, laid out   *
+ *   as a symbol_t is so the table can use them where they are mapped:       *
+ *      0  u32  label: offset into the string pool, 0 if none                *
+ *      4  u16  offset                                                       *
+ *      6  u16  block length, 0 unless a .BLOCK                              *
+ *      8  u8   symbol type, a symtype_t                                     *
+ *      9  3    zero                                                         *
+ *   then the index: a u32 symbol number for each address that has a         *
+ *   symbol, in address order, so the table by address is filled without     *
+ *   searching; then the string pool as a symtab_t holds it: an empty label  *
+ *   and then the zero-terminated labels.                                    *
+ * ************************************************************************* */
+#define PACKAGE_MAGIC "PEP8PKG2"
+#define PACKAGE_MAGIC_SIZE 8
+#define PACKAGE_HEADER_SIZE 32
+#define PACKAGE_SYMBOL_SIZE 12
+
+/* package_open's answer for a file that is not a package */
+#define PACKAGE_NOT_PACKAGE -1
+
+/* The parts of a package, pointing into the file's bytes */
+typedef struct package {
+    const uint8_t* code; //NULL until package_open finds a package
+    uint32_t code_length;
+    uint16_t origin;
+    uint16_t entry;
+    const symbol_t* symbols; //the symbol records
+    uint32_t symbol_count;
+    const uint8_t* index; //the symbol numbers in address order
+    uint32_t index_count;
+    const char* strings; //the string pool, starting with ""
+    uint32_t strings_length;
+} package_t;
+
+/* Prototypes */
+int package_open(const uint8_t*,size_t,package_t*);
+int package_symbols(const package_t*,symtab_t**,symtab_index_t**);
+int package_write(const char*,const uint8_t*,uint32_t,uint16_t,uint16_t,
+		  symtab_t*,const symtab_index_t*);
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef __PEP8__
 #define __PEP8__
 
+#include <stdint.h>	/* uint8_t, uint16_t */
+
 typedef enum mnemonic {
     STOP, RETTR, MOVSPA, MOVFLGA, BR,
     BRLE, BRLT, BREQ, BRNE, BRGE, //10
@@ -24,6 +26,33 @@ typedef enum mnemonic {
 #define NUMBER_OF_MNEMONICS (WORD_mnem + 1)
 #define INVALID_MNEMONIC_ID -1
 
+//define "Does not exist" variable for registr and addr_mode
+#define DNE 255
+
+struct symbol; //symbol_t, see disasm.h
+
+/* One decoded instruction or directive.  The disassembler lists them and
+ * the interpreter executes them, so both decode into this one record: the
+ * opcode fields come from OPCODES (see proc-const.c) on both sides.
+ * addr is an offset into the image in a listing and a guest address in
+ * the interpreter; symb, ascii_bytes and single_digit_addressing are only
+ * filled in by the disassembler, and inst_reg only by the interpreter. */
+//largest fields first, so a record packs into 24 bytes
+typedef struct instruction_t {
+    struct symbol* symb;
+    uint32_t inst_reg; //the 3 bytes the interpreter fetched for it
+    uint16_t addr;
+    uint16_t op_spec; //if unary is true, op_spec arbitrarily set to DNE
+    uint16_t ascii_bytes; //number of bytes in ascii string
+    uint8_t inst_spec; //instruction specifier
+    uint8_t registr; //DNE if does not apply to this instruction
+    uint8_t addr_mode; //DNE if does not apply to this instruction
+    uint8_t mnem; //a mnemonic_t
+    _Bool unary; //unary means no op-spec
+    _Bool single_digit_addressing;
+	//for branch and call instructions for "i,x"; preset to false
+} instruction_t;
+
 /* Global constants defined in pep8-const.c */
 extern const char *MNEMONICS[];
 
@@ -0,0 +1,31 @@
+/* ************************************************************************* *
+ * timer.c                                                                   *
+ * -------                                                                   *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Wall clock used for the -t statistics.                         *
+ * ************************************************************************* */
+
+
+/* ************************************************************************* *
+ * Library includes here.  For documentation of standard C library           *
+ * functions, see the list at:                                               *
+ *   http://pubs.opengroup.org/onlinepubs/009695399/functions/contents.html  *
+ * ************************************************************************* */
+
+#include <time.h>               /* clock_gettime */
+
+#include "timer.h"              /* header file */
+
+/* ************************************************************************* *
+ * Purpose: Read a monotonic clock                                           *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      double: seconds since an arbitrary fixed point; only differences     *
+ *              between two calls are meaningful                             *
+ * ************************************************************************* */
+double timer_now()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
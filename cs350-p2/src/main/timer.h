@@ -0,0 +1,14 @@
+#ifndef __TIMER__
+#define __TIMER__
+
+/* ************************************************************************* *
+ * timer.h                                                                   *
+ * -------                                                                   *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Header file for timer.c                                        *
+ * ************************************************************************* */
+
+/* Prototypes */
+double timer_now();
+
+#endif
@@ -0,0 +1,701 @@
+/* ************************************************************************* *
+ * emit-c.c                                                                  *
+ * --------                                                                  *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Ahead-of-time translation (-c FILE).  Writes the program as    *
+ *            one self-contained C file: every instruction in the            *
+ *            disassembler's list becomes a labelled run of straight-line C, *
+ *            branches become gotos, and a switch on the pc dispatches to    *
+ *            any other target.  Built with the system compiler, the result  *
+ *            prints exactly what interpret_memory prints for the trace      *
+ *            level given on its command line (full by default).             *
+ * ************************************************************************* */
+
+/* ************************************************************************* *
+ * Library includes here.                                                    *
+ * ************************************************************************* */
+
+#include <stdio.h>              /* standard I/O */
+#include <stdint.h>             /* uint8_t, uint16_t */
+#include <stdbool.h>            /* bool types */
+#include <string.h>             /* memset */
+
+#include "emit-c.h"		/* header file */
+#include "../interp/interp.h"	/* describe_opcode */
+#include "../interp/bus.h"	/* ADDRESS_SPACE_SIZE */
+#include "../main/pep8.h"	/* mnemonics */
+
+/* ************************************************************************* *
+ * Global variable declarations                                              *
+ * ************************************************************************* */
+/* What the generated step does with an instruction specifier */
+typedef enum kind {
+    K_UNSUPPORTED, K_STOP, K_BR, K_BRLE, K_BRLT, K_BREQ, K_BRNE, K_BRGE,
+    K_BRGT, K_NOT, K_NEG, K_DECO, K_CHARO, K_ADD, K_SUB, K_AND, K_OR, K_CP,
+    K_LD, K_LDBYTE, K_ST, K_STBYTE
+} kind_t;
+
+static const char* KINDS[] = {
+    "K_UNSUPPORTED", "K_STOP", "K_BR", "K_BRLE", "K_BRLT", "K_BREQ",
+    "K_BRNE", "K_BRGE", "K_BRGT", "K_NOT", "K_NEG", "K_DECO", "K_CHARO",
+    "K_ADD", "K_SUB", "K_AND", "K_OR", "K_CP", "K_LD", "K_LDBYTE", "K_ST",
+    "K_STBYTE"
+};
+
+//the branch conditions, in the generated code's terms
+static const char* CONDITIONS[] = {
+    [K_BRLE] = "N(&p) || Z(&p)", [K_BRLT] = "N(&p)", [K_BREQ] = "Z(&p)",
+    [K_BRNE] = "!Z(&p)", [K_BRGE] = "!N(&p)", [K_BRGT] = "!N(&p) && !Z(&p)"
+};
+
+//operand suffixes for the comments, by addressing mode
+static const char* MODE_SUFFIX[] = {
+    "i", "d", "n", "s", "sf", "x", "sx", "sxf"
+};
+
+/* The part of the generated file that does not depend on the program: the
+ * semantics of the execute_* helpers in proc-helper.c and the output of
+ * print-interp.c, quirks included. */
+static const char* RUNTIME[] = {
+"/* The cpu.  N and Z are read off the last result, as in flags.h */",
+"typedef struct cpu {",
+"    uint16_t a, x, pc, nz;",
+"    int v, c, halted;",
+"    uint32_t ir;",
+"} cpu_t;",
+"",
+"#define N(p) (((p)->nz >> 15) & 1)",
+"#define Z(p) ((p)->nz == 0)",
+"",
+"enum { FULL, FINAL, OUTPUTS, NONE };",
+"static const char* LEVELS[] = { \"full\", \"final\", \"outputs\", \"none\" };",
+"static int level = FULL;",
+"",
+"static const char* MODES[] = {",
+"    \"Immediate\", \"Direct\", \"Indirect\", \"Stack-relative\",",
+"    \"Stack_relative deferred\", \"Indexed\", \"Stack-indexed\",",
+"    \"Stack-indexed deferred\"",
+"};",
+"",
+"static void divider(void)",
+"{",
+"    printf(\"------------------------------------\\n\");",
+"}",
+"",
+"static void print_cpu(const cpu_t* p)",
+"{",
+"    divider();",
+"    printf(\"%-28s%d %d %d %d \\n\", \"Status bits (NZVC)\", N(p), Z(p),",
+"           p->v, p->c);",
+"    printf(\"%-28s0x%04X\\n\", \"Accumulator (A)\", p->a);",
+"    printf(\"%-28s0x%04X\\n\", \"Index Register (X)\", p->x);",
+"    printf(\"%-28s0x%04X\\n\", \"Program counter (PC)\", p->pc);",
+"    printf(\"%-28s0x%06X\\n\", \"Instruction register (IR)\",",
+"           (unsigned)p->ir);",
+"}",
+"",
+"static void unsupported_instruction(const char* name)",
+"{",
+"    printf(\"The given instruction \\\"%s\\\" is not supported by this\"",
+"           \" interpreter.  Exiting program \\n\", name);",
+"    exit(0);",
+"}",
+"",
+"static void unsupported_addr_mode(const char* name, int mode)",
+"{",
+"    printf(\"The given instruction %s's addressing mode: %s is not \"",
+"           \"supported bythis interpreter. Exiting program \\n\", name,",
+"           mode >= 2 && mode <= 7 ? MODES[mode] : \"Invalid\");",
+"    exit(0);",
+"}",
+"",
+"static void invalid_addr_mode(const char* name, int mode)",
+"{",
+"    printf(\"The given instruction %s's addressing mode: %s is not valid \"",
+"           \"forthis instruction\\n\", name, MODES[mode]);",
+"    exit(1);",
+"}",
+"",
+"static uint16_t word_at(uint16_t address)",
+"{",
+"    return (memory[address] << 8) + memory[(uint16_t)(address + 1)];",
+"}",
+"",
+"/* ADDr, SUBr, ANDr, ORr and LDr take immediate or direct operands only */",
+"static uint16_t operand(int mode, uint16_t op_spec, const char* name)",
+"{",
+"    if (mode == 0)",
+"        return op_spec;",
+"    if (mode == 1)",
+"        return word_at(op_spec);",
+"    unsupported_addr_mode(name, mode);",
+"    return 0;",
+"}",
+"",
+"static uint16_t* reg(cpu_t* p, int r)",
+"{",
+"    return r == 0 ? &p->a : &p->x;",
+"}",
+"",
+"/* flip_bits in proc-helper.c never sets bit 0 */",
+"static uint16_t flip_bits(uint16_t value)",
+"{",
+"    return ~value & 0xFFFE;",
+"}",
+"",
+"/* The fetch and increment half of a step; the full trace shows it */",
+"static void step(cpu_t* p, uint16_t next, uint32_t ir)",
+"{",
+"    p->pc = next;",
+"    p->ir = ir;",
+"    if (level == FULL)",
+"        print_cpu(p);",
+"}",
+"",
+"static void op_add(cpu_t* p, int r, int mode, uint16_t op_spec,",
+"                   const char* name)",
+"{",
+"    uint16_t right = operand(mode, op_spec, name);",
+"    uint16_t left = *reg(p, r);",
+"    uint16_t result = left + right;",
+"    p->v = (((left ^ result) & (right ^ result)) >> 15) & 1;",
+"    p->c = (uint32_t)left + right > 0xFFFF;",
+"    *reg(p, r) = p->nz = result;",
+"}",
+"",
+"static void op_sub(cpu_t* p, int r, int mode, uint16_t op_spec,",
+"                   const char* name)",
+"{",
+"    uint16_t right = operand(mode, op_spec, name);",
+"    uint16_t left = *reg(p, r);",
+"    uint16_t result = left - right;",
+"    p->v = (((left ^ right) & (left ^ result)) >> 15) & 1;",
+"    p->c = left >= right;",
+"    *reg(p, r) = p->nz = result;",
+"}",
+"",
+"static void op_and(cpu_t* p, int r, int mode, uint16_t op_spec,",
+"                   const char* name)",
+"{",
+"    *reg(p, r) &= operand(mode, op_spec, name);",
+"    p->nz = *reg(p, r);",
+"}",
+"",
+"/* execute_orr ORs the operand specifier itself into X */",
+"static void op_or(cpu_t* p, int r, int mode, uint16_t op_spec,",
+"                  const char* name)",
+"{",
+"    uint16_t right = operand(mode, op_spec, name);",
+"    if (r == 0)",
+"        p->a |= right;",
+"    else",
+"        p->x |= op_spec;",
+"    p->nz = *reg(p, r);",
+"}",
+"",
+"/* execute_cpr compares with the operand specifier in every mode */",
+"static void op_cp(cpu_t* p, int r, uint16_t op_spec)",
+"{",
+"    uint16_t left = *reg(p, r);",
+"    uint16_t result = left - op_spec;",
+"    p->v = (((left ^ op_spec) & (left ^ result)) >> 15) & 1;",
+"    p->c = left >= op_spec;",
+"    p->nz = result;",
+"}",
+"",
+"static void op_not(cpu_t* p, int r)",
+"{",
+"    *reg(p, r) = p->nz = flip_bits(*reg(p, r));",
+"}",
+"",
+"static void op_neg(cpu_t* p, int r)",
+"{",
+"    p->v = *reg(p, r) == 0x8000;",
+"    *reg(p, r) = p->nz = flip_bits(*reg(p, r)) + 1;",
+"}",
+"",
+"static void op_ld(cpu_t* p, int r, int mode, uint16_t op_spec,",
+"                  const char* name)",
+"{",
+"    *reg(p, r) = p->nz = operand(mode, op_spec, name);",
+"}",
+"",
+"/* execute_ldbyter: the high byte comes from A (i) or X (d) */",
+"static void op_ldbyte(cpu_t* p, int r, int mode, uint16_t op_spec,",
+"                      const char* name)",
+"{",
+"    uint16_t value = 0;",
+"    if (mode == 0)",
+"        value = (p->a & 0xFF00) + (uint8_t)op_spec;",
+"    else if (mode == 1)",
+"        value = (p->x & 0xFF00) + (uint8_t)op_spec;",
+"    else",
+"        unsupported_addr_mode(name, mode);",
+"    *reg(p, r) = p->nz = value;",
+"}",
+"",
+"static void op_st(cpu_t* p, int r, int mode, uint16_t op_spec,",
+"                  const char* name)",
+"{",
+"    if (level == FULL)",
+"        divider();",
+"    if (mode == 1)",
+"    {",
+"        uint8_t most_sig_byte = *reg(p, r) >> 8;",
+"        uint8_t least_sig_byte = *reg(p, r);",
+"        memory[op_spec] = most_sig_byte;",
+"        memory[(uint16_t)(op_spec + 1)] = least_sig_byte;",
+"        if (level == FULL)",
+"        {",
+"            printf(\"  Mem[%04X] <-- 0x%04X\\n\", op_spec, most_sig_byte);",
+"            printf(\"  MEM[%04X] <-- 0x%04X\\n\", op_spec + 1,",
+"                   least_sig_byte);",
+"        }",
+"    }",
+"    else if (mode == 0)",
+"        invalid_addr_mode(name, mode);",
+"    else",
+"        unsupported_addr_mode(name, mode);",
+"}",
+"",
+"static void op_stbyte(cpu_t* p, int r, int mode, uint16_t op_spec,",
+"                      const char* name)",
+"{",
+"    if (level == FULL)",
+"        divider();",
+"    if (mode == 1)",
+"    {",
+"        memory[op_spec] = *reg(p, r);",
+"        if (level == FULL)",
+"            printf(\"  Mem[%04X] <-- 0x%04X\\n\", op_spec, memory[op_spec]);",
+"    }",
+"    else if (mode == 0)",
+"        invalid_addr_mode(name, mode);",
+"    else",
+"        unsupported_addr_mode(name, mode);",
+"}",
+"",
+"static void op_deco(int mode, uint16_t op_spec, const char* name)",
+"{",
+"    int16_t value;",
+"    if (level == FULL)",
+"        divider();",
+"    if (mode == 0)",
+"        value = op_spec;",
+"    else if (mode == 1)",
+"        value = word_at(op_spec);",
+"    else",
+"    {",
+"        unsupported_addr_mode(name, mode);",
+"        return;",
+"    }",
+"    if (level == FULL)",
+"        printf(\"  Output: %d\\n\", value);",
+"    else if (level == OUTPUTS)",
+"        printf(\"%d\", value);",
+"}",
+"",
+"static void op_charo(int mode, uint16_t op_spec, const char* name)",
+"{",
+"    uint8_t character;",
+"    if (level == FULL)",
+"        divider();",
+"    if (mode == 0)",
+"        character = op_spec;",
+"    else if (mode == 1)",
+"        character = memory[op_spec];",
+"    else",
+"    {",
+"        unsupported_addr_mode(name, mode);",
+"        return;",
+"    }",
+"    if (level == FULL && isprint(character))",
+"        printf(\"  Output '%c'\\n\", character);",
+"    else if (level == FULL)",
+"        printf(\"  Output '\\\\x%02X'\\n\", character);",
+"    else if (level == OUTPUTS)",
+"        putchar(character);",
+"}",
+"",
+"/* One entry per instruction specifier, for the generic step */",
+"typedef struct op {",
+"    uint8_t kind, registr, addr_mode, unary;",
+"    const char* name;",
+"} op_t;",
+"",
+"enum {",
+"    K_UNSUPPORTED, K_STOP, K_BR, K_BRLE, K_BRLT, K_BREQ, K_BRNE, K_BRGE,",
+"    K_BRGT, K_NOT, K_NEG, K_DECO, K_CHARO, K_ADD, K_SUB, K_AND, K_OR, K_CP,",
+"    K_LD, K_LDBYTE, K_ST, K_STBYTE",
+"};",
+NULL
+};
+
+/* The generic step: fetch, decode through OPS and execute one instruction
+ * from memory.  Used for targets that are not translated and for
+ * instructions whose bytes the program stores to. */
+static const char* GENERIC_STEP[] = {
+"interpret:",
+"    {",
+"        const op_t* op = &OPS[memory[p.pc]];",
+"        uint32_t ir = (memory[p.pc] << 16) |",
+"            (memory[(uint16_t)(p.pc + 1)] << 8) |",
+"            memory[(uint16_t)(p.pc + 2)];",
+"        uint16_t op_spec = op->unary ? 255 : (uint16_t)ir;",
+"        int r = op->registr, mode = op->addr_mode;",
+"        step(&p, p.pc + (op->unary ? 1 : 3), ir);",
+"        switch (op->kind)",
+"        {",
+"        case K_STOP: p.halted = 1; break;",
+"        case K_BR: p.pc = op_spec; break;",
+"        case K_BRLE: if (N(&p) || Z(&p)) p.pc = op_spec; break;",
+"        case K_BRLT: if (N(&p)) p.pc = op_spec; break;",
+"        case K_BREQ: if (Z(&p)) p.pc = op_spec; break;",
+"        case K_BRNE: if (!Z(&p)) p.pc = op_spec; break;",
+"        case K_BRGE: if (!N(&p)) p.pc = op_spec; break;",
+"        case K_BRGT: if (!N(&p) && !Z(&p)) p.pc = op_spec; break;",
+"        case K_NOT: op_not(&p, r); break;",
+"        case K_NEG: op_neg(&p, r); break;",
+"        case K_DECO: op_deco(mode, op_spec, op->name); break;",
+"        case K_CHARO: op_charo(mode, op_spec, op->name); break;",
+"        case K_ADD: op_add(&p, r, mode, op_spec, op->name); break;",
+"        case K_SUB: op_sub(&p, r, mode, op_spec, op->name); break;",
+"        case K_AND: op_and(&p, r, mode, op_spec, op->name); break;",
+"        case K_OR: op_or(&p, r, mode, op_spec, op->name); break;",
+"        case K_CP: op_cp(&p, r, op_spec); break;",
+"        case K_LD: op_ld(&p, r, mode, op_spec, op->name); break;",
+"        case K_LDBYTE: op_ldbyte(&p, r, mode, op_spec, op->name); break;",
+"        case K_ST:",
+"            op_st(&p, r, mode, op_spec, op->name);",
+"            if (TRANSLATED[op_spec] || TRANSLATED[(uint16_t)(op_spec + 1)])",
+"                dynamic = 1;",
+"            break;",
+"        case K_STBYTE:",
+"            op_stbyte(&p, r, mode, op_spec, op->name);",
+"            if (TRANSLATED[op_spec])",
+"                dynamic = 1;",
+"            break;",
+"        default: unsupported_instruction(op->name);",
+"        }",
+"    }",
+"    goto dispatch;",
+NULL
+};
+
+/* ************************************************************************* *
+ * Purpose: Map an OPCODES entry to what the generated code does with it     *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      info: the entry, from describe_opcode                                *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      kind_t: K_UNSUPPORTED for everything the interpreter stops on        *
+ * ************************************************************************* */
+static kind_t kind_of(opcode_info_t* info)
+{
+    if (!info->supported)
+	return K_UNSUPPORTED;
+    switch (info->mnem)
+    {
+    case STOP: return K_STOP;
+    case BR: return K_BR;
+    case BRLE: return K_BRLE;
+    case BRLT: return K_BRLT;
+    case BREQ: return K_BREQ;
+    case BRNE: return K_BRNE;
+    case BRGE: return K_BRGE;
+    case BRGT: return K_BRGT;
+    case NOTA: case NOTX: return K_NOT;
+    case NEGA: case NEGX: return K_NEG;
+    case DECO: return K_DECO;
+    case CHARO: return K_CHARO;
+    case ADDA: case ADDX: return K_ADD;
+    case SUBA: case SUBX: return K_SUB;
+    case ANDA: case ANDX: return K_AND;
+    case ORA: case ORX: return K_OR;
+    case CPA: case CPX: return K_CP;
+    case LDA: case LDX: return K_LD;
+    case LDBYTEA: case LDBYTEX: return K_LDBYTE;
+    case STA: case STX: return K_ST;
+    case STBYTEA: case STBYTEX: return K_STBYTE;
+    default: return K_UNSUPPORTED;
+    }
+}
+
+static void emit_lines(FILE* fp,const char** lines)
+{
+    for (; *lines != NULL; lines++)
+	fprintf(fp,"%s\n",*lines);
+}
+
+//addresses wrap at 0xFFFF, as they do for the interpreter
+static uint8_t byte_at(uint8_t* memory,int address)
+{
+    return memory[(uint16_t)address];
+}
+
+//where a listed instruction sits in the address space
+static uint16_t guest_address(instruction_t* inst,uint16_t origin)
+{
+    return origin + inst->addr;
+}
+
+//whether the list entry is an instruction inside the program
+static bool is_code(instruction_t* inst,int mem_length)
+{
+    return inst->mnem < ASCII_mnem && inst->addr < mem_length;
+}
+
+/* ************************************************************************* *
+ * Purpose: Emit one translated instruction                                  *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      fp: the C file                                                       *
+ *      addr: its address                                                    *
+ *      inst: the disassembled instruction                                   *
+ *      symtab: the symbol table inst's symbol is in                         *
+ *      memory: the address space with the program loaded                    *
+ *      label: nonzero at every address that has a translation               *
+ *      stored: nonzero at every byte a direct store in the list writes      *
+ *      following: the address of the next translation emitted, or -1        *
+ * ************************************************************************* */
+static void emit_instruction(FILE* fp,uint16_t addr,instruction_t* inst,
+			     const symtab_t* symtab,uint8_t* memory,
+			     uint8_t* label,uint8_t* stored,int following)
+{
+    opcode_info_t info;
+    describe_opcode(memory[addr],&info);
+    kind_t kind = kind_of(&info);
+    uint32_t ir = (memory[addr] << 16) | (byte_at(memory,addr + 1) << 8) |
+	byte_at(memory,addr + 2);
+    uint16_t op_spec = info.unary ? 255 : (ir & 0xFFFF);
+    uint16_t next = addr + (info.unary ? 1 : 3);
+    uint16_t after1 = addr + 1;
+    uint16_t after2 = addr + 2;
+    const char* name = MNEMONICS[info.mnem];
+    int r = info.registr;
+    int mode = info.addr_mode;
+
+    fprintf(fp,"L_%04X: /* ",addr);
+    if (inst->symb != NULL && inst->symb->type == LINE)
+	fprintf(fp,"%s: ",symbol_label(symtab,inst->symb));
+    if (info.unary)
+	fprintf(fp,"%s */\n",name);
+    else
+	fprintf(fp,"%s 0x%04X,%s */\n",name,op_spec,MODE_SUFFIX[mode]);
+    if (info.unary && (stored[after1] || stored[after2]))
+	//the IR shows the two bytes after it, and the program changes them
+	fprintf(fp,"    step(&p, 0x%04X, 0x%06X | (memory[0x%04X] << 8) | "
+		"memory[0x%04X]);\n",next,ir & 0xFF0000,after1,after2);
+    else
+	fprintf(fp,"    step(&p, 0x%04X, 0x%06X);\n",next,ir);
+
+    switch (kind)
+    {
+    case K_UNSUPPORTED:
+	fprintf(fp,"    unsupported_instruction(\"%s\");\n",name);
+	return;
+    case K_STOP:
+	fprintf(fp,"    p.halted = 1;\n    goto end;\n");
+	return;
+    case K_BR:
+    case K_BRLE: case K_BRLT: case K_BREQ: case K_BRNE: case K_BRGE:
+    case K_BRGT:
+	if (kind != K_BR)
+	    fprintf(fp,"    if (%s)\n    ",CONDITIONS[kind]);
+	if (label[op_spec])
+	    fprintf(fp,"    { p.pc = 0x%04X; goto L_%04X; }\n",op_spec,op_spec);
+	else
+	    fprintf(fp,"    { p.pc = 0x%04X; goto dispatch; }\n",op_spec);
+	if (kind == K_BR)
+	    return;
+	break;
+    case K_NOT: fprintf(fp,"    op_not(&p, %d);\n",r); break;
+    case K_NEG: fprintf(fp,"    op_neg(&p, %d);\n",r); break;
+    case K_DECO:
+	fprintf(fp,"    op_deco(%d, 0x%04X, \"%s\");\n",mode,op_spec,name);
+	break;
+    case K_CHARO:
+	fprintf(fp,"    op_charo(%d, 0x%04X, \"%s\");\n",mode,op_spec,name);
+	break;
+    case K_CP: fprintf(fp,"    op_cp(&p, %d, 0x%04X);\n",r,op_spec); break;
+    default: //the register/mode/operand helpers
+	fprintf(fp,"    op_%s(&p, %d, %d, 0x%04X, \"%s\");\n",
+		kind == K_ADD ? "add" : kind == K_SUB ? "sub" :
+		kind == K_AND ? "and" : kind == K_OR ? "or" :
+		kind == K_LD ? "ld" : kind == K_LDBYTE ? "ldbyte" :
+		kind == K_ST ? "st" : "stbyte",r,mode,op_spec,name);
+	break;
+    }
+
+    //carry on at the next address
+    if (next == following)
+	return;
+    if (label[next])
+	fprintf(fp,"    goto L_%04X;\n",next);
+    else
+	fprintf(fp,"    goto dispatch;\n");
+}
+
+/* ************************************************************************* *
+ * Purpose: Write the program as a self-contained C file                     *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      filename: the C file to create                                       *
+ *      source: the object file's name, for the header comment               *
+ *      instructions: the list from determine_instructions                   *
+ *      symtab: the symbol table, for the labels in comments                 *
+ *      memory: the address space with the program loaded                    *
+ *      mem_length: the length of the program                                *
+ *      origin: where the program was loaded                                 *
+ *      entry: where the run starts                                          *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      0 - if success                                                       *
+ *      1 - if failure                                                       *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      Only what the list says is code gets translated.  An instruction     *
+ *      with a byte that some direct STr/STBYTEr in the list writes to is    *
+ *      left to the generic step, which fetches it from memory when it       *
+ *      runs.  So is any branch target that is not the start of a            *
+ *      translation, and everything once a store from the generic step       *
+ *      lands on translated bytes.                                           *
+ * ************************************************************************* */
+int emit_c(const char* filename,const char* source,inst_list_t* instructions,
+	   const symtab_t* symtab,uint8_t* memory,int mem_length,
+	   uint16_t origin,uint16_t entry)
+{
+    static uint8_t stored[ADDRESS_SPACE_SIZE]; //bytes the program stores to
+    static uint8_t label[ADDRESS_SPACE_SIZE]; //starts of translations
+    static uint8_t translated[ADDRESS_SPACE_SIZE]; //bytes they cover
+    opcode_info_t info;
+    instruction_t* inst;
+    int addr;
+    int i;
+    size_t n;
+
+    FILE* fp = fopen(filename,"w");
+    if (fp == NULL)
+    {
+	printf("Cannot create C file \"%s\"\n",filename);
+	return 1;
+    }
+    memset(stored,0,sizeof(stored));
+    memset(label,0,sizeof(label));
+    memset(translated,0,sizeof(translated));
+
+    //the static store targets
+    for (n = 0; n < instructions->count; n++)
+    {
+	inst = &instructions->items[n];
+	if (!is_code(inst,mem_length))
+	    continue;
+	addr = guest_address(inst,origin);
+	describe_opcode(memory[addr],&info);
+	uint16_t op_spec = (byte_at(memory,addr + 1) << 8) |
+	    byte_at(memory,addr + 2);
+	if (!info.supported || info.addr_mode != 1)
+	    continue;
+	if (kind_of(&info) == K_ST)
+	{
+	    stored[op_spec] = 1;
+	    stored[(uint16_t)(op_spec + 1)] = 1;
+	}
+	else if (kind_of(&info) == K_STBYTE)
+	    stored[op_spec] = 1;
+    }
+
+    //what gets translated
+    for (n = 0; n < instructions->count; n++)
+    {
+	inst = &instructions->items[n];
+	if (!is_code(inst,mem_length))
+	    continue;
+	addr = guest_address(inst,origin);
+	describe_opcode(memory[addr],&info);
+	int size = info.unary ? 1 : 3;
+	bool clean = true;
+	for (i = 0; i < size; i++)
+	    clean = clean && !stored[(uint16_t)(addr + i)];
+	if (!clean)
+	    continue;
+	label[addr] = 1;
+	for (i = 0; i < size; i++)
+	    translated[(uint16_t)(addr + i)] = 1;
+    }
+
+    fprintf(fp,"/* Generated by pep8 -c from %s.  Run it with a trace level\n"
+	    " * (full, final, outputs or none) as its only argument. */\n\n",
+	    source);
+    fprintf(fp,"#include <stdio.h>\n#include <stdint.h>\n#include <stdlib.h>\n"
+	    "#include <string.h>\n#include <ctype.h>\n\n");
+    fprintf(fp,"#define ORIGIN 0x%04X\n#define ENTRY 0x%04X\n\n",origin,
+	    entry);
+    fprintf(fp,"static uint8_t memory[0x10000] = {\n    [ORIGIN] =");
+    for (addr = 0; addr < mem_length; addr++)
+	fprintf(fp,"%s0x%02X,",addr % 12 == 0 ? "\n        " : " ",
+		memory[origin + addr]);
+    fprintf(fp,"\n};\n\n");
+    emit_lines(fp,RUNTIME);
+
+    fprintf(fp,"\nstatic const op_t OPS[256] = {\n");
+    for (addr = 0; addr < 256; addr++)
+    {
+	describe_opcode(addr,&info);
+	fprintf(fp,"    { %s, %d, %d, %d, \"%s\" },\n",KINDS[kind_of(&info)],
+		info.registr,info.addr_mode,info.unary,MNEMONICS[info.mnem]);
+    }
+    fprintf(fp,"};\n\nstatic const uint8_t TRANSLATED[0x10000] = {");
+    int count = 0;
+    for (addr = 0; addr < ADDRESS_SPACE_SIZE; addr++)
+	if (translated[addr])
+	    fprintf(fp,"%s[0x%04X] = 1,",count++ % 6 == 0 ? "\n    " : " ",
+		    addr);
+    fprintf(fp,"\n};\n\n");
+
+    fprintf(fp,"int main(int argc, char** argv)\n{\n"
+	    "    cpu_t p = { 0, 0, ENTRY, 1, 0, 0, 0, 0 };\n"
+	    "    int dynamic = 0;\n\n"
+	    "    if (argc > 1)\n    {\n"
+	    "        for (level = FULL; level <= NONE; level++)\n"
+	    "            if (strcmp(argv[1], LEVELS[level]) == 0)\n"
+	    "                break;\n"
+	    "        if (level > NONE)\n        {\n"
+	    "            printf(\"Unknown trace level \\\"%%s\\\"\\n\", argv[1]);\n"
+	    "            return 1;\n        }\n    }\n"
+	    "    goto dispatch;\n\n");
+
+    //the translations, in address order
+    for (n = 0; n < instructions->count; n++)
+    {
+	inst = &instructions->items[n];
+	if (!is_code(inst,mem_length) || !label[guest_address(inst,origin)])
+	    continue;
+	size_t after = n + 1;
+	while (after < instructions->count &&
+	       (!is_code(&instructions->items[after],mem_length) ||
+		!label[guest_address(&instructions->items[after],origin)]))
+	    after++;
+	emit_instruction(fp,guest_address(inst,origin),inst,symtab,memory,label,
+			 stored,after < instructions->count ?
+			 guest_address(&instructions->items[after],origin) : -1);
+    }
+
+    fprintf(fp,"\ndispatch:\n"
+	    "    if (p.halted)\n        goto end;\n"
+	    "    if (dynamic)\n        goto interpret;\n"
+	    "    switch (p.pc)\n    {\n");
+    for (addr = 0; addr < ADDRESS_SPACE_SIZE; addr++)
+	if (label[addr])
+	    fprintf(fp,"    case 0x%04X: goto L_%04X;\n",addr,addr);
+    fprintf(fp,"    default: break;\n    }\n");
+    emit_lines(fp,GENERIC_STEP);
+    fprintf(fp,"\nend:\n"
+	    "    if (level == FINAL)\n        print_cpu(&p);\n"
+	    "    if (level == FULL || level == FINAL)\n        divider();\n"
+	    "    return 0;\n}\n");
+
+    fclose(fp);
+    return 0;
+}
@@ -0,0 +1,23 @@
+#ifndef __EMIT_C__
+#define __EMIT_C__
+
+/* ************************************************************************* *
+ * emit-c.h                                                                  *
+ * --------                                                                  *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Header file for emit-c.c                                       *
+ * ************************************************************************* */
+
+
+/* ************************************************************************* *
+ * Library includes here. If none needed, delete this comment.               *
+ * ************************************************************************* */
+#include "../disasm/disasm.h"          /* disasm structs and types */
+
+
+/* ************************************************************************* *
+ * Function prototypes here. Note that variable names are often omitted.     *
+ * ************************************************************************* */
+int emit_c(const char*,const char*,inst_list_t*,const symtab_t*,uint8_t*,
+	   int,uint16_t,uint16_t);
+#endif
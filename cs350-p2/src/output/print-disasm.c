@@ -11,28 +11,115 @@
 
 #include <stdio.h>              /* standard I/O */
 #include <inttypes.h>           /* allows PRIu8 */
-#include <string.h>		/* strcat */
-#include <stdlib.h>		/* malloc */
+#include <string.h>		/* strlen, memcpy */
+#include <stdlib.h>		/* exit */
+#include <stdbool.h>		/* bool types */
 
 #include "../main/debug.h"      /* DEBUG statements */
 #include "print-disasm.h"	/* header file */
 /* ************************************************************************* *
  * Local function prototypes                                                 *
  * ************************************************************************* */
+static void put_bytes(const char*,size_t);
+static void put_char(char);
+static void put_string(const char*);
+static void put_hex(uint64_t,int);
+static void make_mnemonic_columns();
 
 /* ************************************************************************* *
  * Global variable declarations                                              *
  * ************************************************************************* */
+#define LISTING_BUFFER_SIZE (1 << 16) //the listing is written in 64 KB blocks
+
+static char listing[LISTING_BUFFER_SIZE]; //lines not yet written to stdout
+static size_t listed = 0; //bytes in listing
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+//the mnemonic column, each name padded to 10 as "%-10s" would
+static char mnemonic_columns[NUMBER_OF_MNEMONICS][11];
+static _Bool have_mnemonic_columns = false;
+
+//operand suffixes by addressing mode, for the "aaa" and "a" fields
+static const char *ADDR_MODES[] = {
+    ",i", ",d", ",n", ",s", ",sf", ",x", ",sx", ",sxf"
+};
+static const char *SINGLE_DIGIT_ADDR_MODES[] = {
+    ",i", ",x"
+};
+
+/* ************************************************************************* *
+ * Listing buffer helpers.  Every print_ function below appends to listing   *
+ * with these instead of calling printf; print_last_line writes it out, and  *
+ * print_listing_flush writes out what there is so far.                      *
+ * ************************************************************************* */
+void print_listing_flush(void)
+{
+    fwrite(listing,1,listed,stdout);
+    listed = 0;
+}
+
+static void put_bytes(const char* bytes,size_t length)
+{
+    if (listed + length > LISTING_BUFFER_SIZE)
+    {
+	print_listing_flush();
+	if (length > LISTING_BUFFER_SIZE) //too big to buffer, write it now
+	{
+	    fwrite(bytes,1,length,stdout);
+	    return;
+	}
+    }
+    memcpy(listing + listed,bytes,length);
+    listed += length;
+}
+
+static void put_char(char c)
+{
+    if (listed == LISTING_BUFFER_SIZE)
+	print_listing_flush();
+    listing[listed++] = c;
+}
+
+static void put_string(const char* string)
+{
+    put_bytes(string,strlen(string));
+}
+
+//value as exactly digits upper-case hex digits, like "%0<digits>X"
+static void put_hex(uint64_t value,int digits)
+{
+    char text[16];
+    int i = 0;
+    for (i = digits - 1; i >= 0; i--)
+    {
+	text[i] = HEX_DIGITS[value & 0xF];
+	value >>= 4;
+    }
+    put_bytes(text,digits);
+}
+
+//fill in mnemonic_columns before the first line that uses it
+static void make_mnemonic_columns()
+{
+    int i = 0;
+    if (have_mnemonic_columns)
+	return;
+    for (i = 0; i < NUMBER_OF_MNEMONICS; i++)
+	snprintf(mnemonic_columns[i],sizeof(mnemonic_columns[i]),"%-10s",
+		 MNEMONICS[i]);
+    have_mnemonic_columns = true;
+}
 
 /* ************************************************************************* *
  * Purpose: Print Introductory line of disassembler                          *
  * ************************************************************************* */
 void print_first_line()
 {
-    printf("\n");
-    printf("--------------------------------------\n");
-    printf("Addr  Code   Symbol  Mnemonic  Operand\n");
-    printf("--------------------------------------\n");
+    make_mnemonic_columns();
+    put_string("\n");
+    put_string("--------------------------------------\n");
+    put_string("Addr  Code   Symbol  Mnemonic  Operand\n");
+    put_string("--------------------------------------\n");
 }
 
 /* ************************************************************************* *
@@ -41,34 +128,54 @@ void print_first_line()
  * Parameters:							 	     *
  *     instructions -- the list of instructions to print out		     *
  *     memory -- the array of bytes in memory 				     *
+ *     symbols -- the symbol table by address, or NULL if there is none      *
+ *                                                                           *
+ * Notes:                                                                    *
+ *     Lines are formatted into a buffer and written to stdout a block at a  *
+ *     time; the output is the same as printing each field with printf.      *
  * ************************************************************************* */
-void print_disassembler(instruction_t* instructions, uint8_t* memory,
-			symtab_t** symtab)
+void print_disassembler(inst_list_t* instructions, uint8_t* memory,
+			const symtab_index_t* symbols)
 {
-    print_first_line();
-    instruction_t* cur_inst = instructions;
-    uint8_t more_than_three_bytes = 0; //set to 1 if code is more than 3 bytes
+    size_t i = 0;
 
-    if (cur_inst != NULL)
+    print_first_line();
+    for (i = 0; i < instructions->count; i++)
     {
-        while (cur_inst != NULL)
-        {
-	    print_address(cur_inst);
-	    more_than_three_bytes = print_code(cur_inst);
-	    print_symbol(cur_inst);
-	    print_mnemonic(cur_inst);
-	    print_operand(cur_inst,memory,symtab);
-	    printf("\n");
-	    if (more_than_three_bytes)
-		print_excess_bytes(cur_inst,memory);
-	    if (cur_inst->next != NULL)
-                cur_inst = cur_inst->next;
-	    else
-		break;
-        }
+	print_address(&instructions->items[i]);
+	print_line(&instructions->items[i],memory,symbols);
     }
+    print_last_line();
+}
 
-    printf("\n\n"); //looks cleaner this way
+/* ************************************************************************* *
+ * Purpose: Print the rest of a listing line after the address               *
+ *                                                                           *
+ * Parameters:                                                               *
+ *     instructions -- the instruction or directive to print                 *
+ *     memory -- the array of bytes in memory                                *
+ *     symbols -- the symbol table by address, or NULL if there is none      *
+ * ************************************************************************* */
+void print_line(instruction_t* instructions, uint8_t* memory,
+		const symtab_index_t* symbols)
+{
+    uint8_t more_than_three_bytes = 0; //set to 1 if code is more than 3 bytes
+    more_than_three_bytes = print_code(instructions);
+    print_symbol(instructions,symbols);
+    print_mnemonic(instructions);
+    print_operand(instructions,memory,symbols);
+    put_char('\n');
+    if (more_than_three_bytes)
+	print_excess_bytes(instructions,memory);
+}
+
+/* ************************************************************************* *
+ * Purpose: End the listing and write out whatever is still buffered         *
+ * ************************************************************************* */
+void print_last_line()
+{
+    put_string("\n\n"); //looks cleaner this way
+    print_listing_flush();
 }
 
 /* ************************************************************************* *
@@ -79,7 +186,22 @@ void print_disassembler(instruction_t* instructions, uint8_t* memory,
  * ************************************************************************* */
 void print_address(instruction_t* instructions)
 {
-    printf("%04X  ",instructions->addr);
+    put_hex(instructions->addr,4);
+    put_string("  ");
+}
+
+/* ************************************************************************* *
+ * Purpose: Print an address that may be past 0xFFFF, for a stream longer    *
+ *          than the address space.  It has four digits like print_address   *
+ *          until it needs more.                                             *
+ * ************************************************************************* */
+void print_offset(uint64_t offset)
+{
+    int digits = 4;
+    while (digits < 16 && (offset >> (4 * digits)) != 0)
+	digits++;
+    put_hex(offset,digits);
+    put_string("  ");
 }
 
 /* ************************************************************************* *
@@ -104,10 +226,14 @@ uint8_t print_code(instruction_t* instructions)
     else
     {
     	//if unary, print just the inst_spec, otherwise both
+    	put_hex(instructions->inst_spec,2);
     	if (instructions->unary)
-            printf("%02X     ",instructions->inst_spec);
+            put_string("     ");
     	else
-            printf("%02X%04X ",instructions->inst_spec,instructions->op_spec);
+	{
+            put_hex(instructions->op_spec,4);
+            put_char(' ');
+	}
 	return 0;
     }
 }
@@ -126,7 +252,9 @@ uint8_t print_pseudo_operand(instruction_t* instructions)
 {
     if (instructions->symb->type == 1) //ASCII
     {
-	printf("%02X%04X ",instructions->inst_spec,instructions->op_spec);	
+	put_hex(instructions->inst_spec,2);
+	put_hex(instructions->op_spec,4);
+	put_char(' ');
 	if (instructions->ascii_bytes > 3)
 	    return 1;
 	else
@@ -134,16 +262,27 @@ uint8_t print_pseudo_operand(instruction_t* instructions)
     }
     else if (instructions->symb->type == 2) //BLOCK
     {
-	if (instructions->symb->block_length == 1)
-	    printf("%02X     ",instructions->inst_spec);	
-	else if (instructions->symb->block_length == 2)
-            printf("%02X%02X   ",instructions->inst_spec,instructions->inst_spec);
-        else if (instructions->symb->block_length == 3)
-            printf("%02X%04X ",instructions->inst_spec,instructions->op_spec);        
+	size_t block_length = instructions->symb->block_length;
+	if (block_length >= 1 && block_length <= 3)
+	    put_hex(instructions->inst_spec,2);
+	if (block_length == 1)
+	    put_string("     ");
+	else if (block_length == 2)
+	{
+            put_hex(instructions->inst_spec,2);
+            put_string("   ");
+	}
+        else if (block_length == 3)
+	{
+            put_hex(instructions->op_spec,4);
+            put_char(' ');
+	}
 	//multiple line block
-	if (instructions->symb->block_length > 3)
+	if (block_length > 3)
 	{
-            printf("%02X%04X ",instructions->inst_spec,instructions->op_spec);
+            put_hex(instructions->inst_spec,2);
+            put_hex(instructions->op_spec,4);
+            put_char(' ');
 	    return 1;
 	}
 	else
@@ -153,11 +292,14 @@ uint8_t print_pseudo_operand(instruction_t* instructions)
     {
         uint8_t byte_1 = instructions->inst_spec;
         uint8_t byte_2 = (uint8_t)(instructions->op_spec >> 8);
-        printf("%02X%02X   ",byte_1,byte_2);
+        put_hex(byte_1,2);
+        put_hex(byte_2,2);
+        put_string("   ");
 	return 0;
     }
     else
     {
+	print_listing_flush();
         printf("Error in print_pseudo_operand, symbol type is: %d\n",
 		instructions->symb->type);
         exit(1);
@@ -183,28 +325,24 @@ void print_excess_bytes(instruction_t* instructions,uint8_t* memory)
 	bytes_left_to_print = instructions->symb->block_length - 3;
     else if (instruction_type == ASCII)
 	bytes_left_to_print = instructions->ascii_bytes - 3;
-    uint8_t number_of_blanks = 6; //used to make the output look pretty
-    int i = 0;
-    for (i = 0; i < number_of_blanks; i++)
-	printf(" ");
+    const char* blanks = "      "; //used to make the output look pretty
+    put_string(blanks);
     while (bytes_left_to_print)
     {
 	if (instruction_type == BLOCK)
-	    printf("00");
+	    put_string("00");
 	else if (instruction_type == ASCII)
-	    printf("%02X",memory[index]);
+	    put_hex(memory[index],2);
 	index++;
 	bytes_left_to_print--;
 	//go to new line
 	if (index - starting_index == 3 && bytes_left_to_print != 0)
 	{
-	    printf("\n");
-	    i = 0;
-	    for(i = 0; i < number_of_blanks; i++)
-		printf(" ");
+	    put_char('\n');
+	    put_string(blanks);
 	}
     }
-    printf("\n");
+    put_char('\n');
 }
 
 /* ************************************************************************* *
@@ -212,25 +350,21 @@ void print_excess_bytes(instruction_t* instructions,uint8_t* memory)
  *                                                                           *
  * Parameters:                                                               *
  *     instructions -- the list of instructions                              *
+ *     symbols -- the symbol table by address, holding the labels            *
  * ************************************************************************* */
-void print_symbol(instruction_t* instructions)
+void print_symbol(instruction_t* instructions,const symtab_index_t* symbols)
 {
-    if (instructions->symb != NULL)
+    size_t width = 0; //of "label:", padded to 8 like "%-8s"
+    const char* label = instructions->symb != NULL ?
+	symbol_label(symbols->symtab,instructions->symb) : NULL;
+    if (label != NULL)
     {
-	//get the : in the symbol label
-	char* label = strdup(instructions->symb->label);
-	if (label != NULL)
-	{
-	    char* colon = ":";
-	    strcat(label,colon);
-	    printf("%-8s",label);
-	    free(label);
-	}
-	else
-        printf("        "); //default to other option if heap allocation fails
+	put_string(label);
+	put_char(':');
+	width = strlen(label) + 1;
     }
-    else
-	printf("        ");
+    for (; width < 8; width++)
+	put_char(' ');
 }
 
 /* ************************************************************************* *
@@ -241,7 +375,7 @@ void print_symbol(instruction_t* instructions)
  * ************************************************************************* */
 void print_mnemonic(instruction_t* instructions)
 {
-    printf("%-10s",MNEMONICS[instructions->mnem]);
+    put_bytes(mnemonic_columns[instructions->mnem],10);
 }
 
 /* ************************************************************************* *
@@ -251,99 +385,139 @@ void print_mnemonic(instruction_t* instructions)
  *     instructions -- the list of instructions                              *
  * ************************************************************************* */
 void print_operand(instruction_t* instructions, uint8_t* memory,
-		   symtab_t** symtab)
+		   const symtab_index_t* symbols)
 {
     //is the instruction a pseudo_op?
     if (instructions->symb != NULL && instructions->symb->type != 0)
     {
 	if (instructions->symb->type == 1) //ASCII
 	{
-	    printf("\"");
-	    uint16_t bytes_left_to_print = instructions->ascii_bytes;
-	    uint16_t index = 0;
-	    char next_byte;
-	    while (bytes_left_to_print)
-	    {
-		next_byte = (char)memory[instructions->addr+index];
-		printf("%c",next_byte);
-		index++;
-		bytes_left_to_print--;
-	    }
-	    printf("\\x");
-	    printf("00\"");
+	    put_char('"');
+	    put_bytes((const char*)memory + instructions->addr,
+		      instructions->ascii_bytes);
+	    put_string("\\x00\"");
 	}
 	else if (instructions->symb->type == 2) //BLOCK
 	{
-	    printf("%zu",instructions->symb->block_length);
+	    char length[24];
+	    snprintf(length,sizeof(length),"%u",
+		     instructions->symb->block_length);
+	    put_string(length);
 	}
 	else if (instructions->symb->type == 3) //WORD
 	{
 	    uint8_t byte_1 = instructions->inst_spec;
 	    uint8_t byte_2 = (uint8_t)(instructions->op_spec >> 8);
-	    printf("0x%02X%02X",byte_1,byte_2);
+	    put_string("0x");
+	    put_hex(byte_1,2);
+	    put_hex(byte_2,2);
 	}
     }
     else
     {
-	char* addr_mode = NULL;
+	const char* addr_mode = NULL;
 	
         //check if operand specifier corresponds to a symbol
-	//if instruction is unary,jump out of loop 
-        symtab_t* cur_sym = *symtab; //current symbol
-        while (cur_sym != NULL && instructions->op_spec != DNE)
-        {
-            if (cur_sym->offset == instructions->op_spec)
-                break; //we have found the symbol
-            if (cur_sym->next != NULL)
-                cur_sym = cur_sym->next;
-	    else
-	        cur_sym = NULL; //no symbol matches the operand specifier
-        }
+	//if instruction is unary, there is no operand to look up
+        symbol_t* cur_sym = NULL; //current symbol
+        if (!instructions->unary)
+            cur_sym = symtab_lookup(symbols,instructions->op_spec);
 
         //is there an addressing mode for this instruction? is it "a" or "aaa"?
         if (instructions->addr_mode != DNE &&
 	    instructions->single_digit_addressing)
         {
-	    if (instructions->addr_mode == 0x00)
-	        addr_mode = ",i";
-	    else if (instructions->addr_mode == 0x01)
-	        addr_mode = ",x";
+	    if (instructions->addr_mode <= 0x01)
+	        addr_mode = SINGLE_DIGIT_ADDR_MODES[instructions->addr_mode];
         }
         else if (instructions->addr_mode != DNE &&
             !instructions->single_digit_addressing)
 	{
-           if (instructions->addr_mode == 0x00)
-                addr_mode = ",i";
-           else if (instructions->addr_mode == 0x01)
-                addr_mode = ",d";
-           else if (instructions->addr_mode == 0x02)
-                addr_mode = ",n";
-           else if (instructions->addr_mode == 0x03)
-                addr_mode = ",s";
-           else if (instructions->addr_mode == 0x04)
-                addr_mode = ",sf";
-           else if (instructions->addr_mode == 0x05)
-                addr_mode = ",x";
-           else if (instructions->addr_mode == 0x06)
-                addr_mode = ",sx";
-           else if (instructions->addr_mode == 0x07)
-                addr_mode = ",sxf";
+           if (instructions->addr_mode <= 0x07)
+                addr_mode = ADDR_MODES[instructions->addr_mode];
 
 	}
 
     	//print out Operand
 	//if a symbol label corresponds and the instruction is not unary
-	if (cur_sym != NULL && !instructions->unary)
-	    printf("%s",cur_sym->label);
+	if (cur_sym != NULL && cur_sym->label != 0 && !instructions->unary)
+	    put_string(symbol_label(symbols->symtab,cur_sym));
 	else
 	{
 	    //if instruction is unary, no operand specifier
 	    if (!instructions->unary)
-	    	printf ("0x%04X", instructions->op_spec);
+	    {
+		put_string("0x");
+	    	put_hex(instructions->op_spec,4);
+	    }
 	}
 	if (addr_mode != NULL)
-	    printf("%s",addr_mode);    
+	    put_string(addr_mode);
     }
 }
 
 
+
+/* ************************************************************************* *
+ * Purpose: Print every line that refers to an address (-x)                  *
+ *                                                                           *
+ * Parameters:                                                               *
+ *     xref -- the cross-reference index                                     *
+ *     instructions -- the list of instructions it was built from            *
+ *     memory -- the array of bytes in memory                                *
+ *     symbols -- the symbol table by address, or NULL if there is none      *
+ *     target -- the address                                                 *
+ *                                                                           *
+ * Notes:                                                                    *
+ *     A summary line counts the references of each kind, then each line     *
+ *     that makes one follows, in address order, as the listing shows it.    *
+ * ************************************************************************* */
+void print_xref(xref_t* xref,inst_list_t* instructions,uint8_t* memory,
+		const symtab_index_t* symbols,uint16_t target)
+{
+    uint32_t counts[NUMBER_OF_XREF_KINDS] = {0};
+    uint32_t i = 0;
+    int kind = 0;
+    const char* separator = ": ";
+    symbol_t* symbol = symtab_lookup(symbols,target);
+
+    make_mnemonic_columns();
+    for (i = xref->first[target]; i < xref->first[target + 1]; i++)
+	counts[xref->kind[i]]++;
+
+    put_string("References to ");
+    if (symbol != NULL && symbol->label != 0)
+    {
+	put_string(symbol_label(symbols->symtab,symbol));
+	put_string(" (0x");
+	put_hex(target,4);
+	put_char(')');
+    }
+    else
+    {
+	put_string("0x");
+	put_hex(target,4);
+    }
+    for (kind = 0; kind < NUMBER_OF_XREF_KINDS; kind++)
+    {
+	if (counts[kind] == 0)
+	    continue;
+	char count[16];
+	snprintf(count,sizeof(count),"%" PRIu32 " ",counts[kind]);
+	put_string(separator);
+	put_string(count);
+	put_string(XREF_KINDS[kind]);
+	separator = ", ";
+    }
+    if (xref->first[target] == xref->first[target + 1])
+	put_string(": none");
+    put_char('\n');
+
+    for (i = xref->first[target]; i < xref->first[target + 1]; i++)
+    {
+	instruction_t* inst = &instructions->items[xref->line[i]];
+	print_address(inst);
+	print_line(inst,memory,symbols);
+    }
+    print_listing_flush();
+}
@@ -13,18 +13,25 @@
  * Library includes here. If none needed, delete this comment.               *
  * ************************************************************************* */
 #include "../disasm/disasm.h"          /* disasm structs and types */
+#include "../disasm/xref.h"            /* xref_t */
 
 
 /* ************************************************************************* *
  * Function prototypes here. Note that variable names are often omitted.     *
  * ************************************************************************* */
 void print_first_line();
-void print_disassembler(instruction_t*,uint8_t*,symtab_t**);
+void print_last_line();
+void print_listing_flush(void);
+void print_disassembler(inst_list_t*,uint8_t*,const symtab_index_t*);
+void print_line(instruction_t*,uint8_t*,const symtab_index_t*);
 void print_address(instruction_t*);
+void print_offset(uint64_t);
 uint8_t print_code(instruction_t*);
-void print_symbol(instruction_t*);
+void print_symbol(instruction_t*,const symtab_index_t*);
 void print_mnemonic(instruction_t*);
-void print_operand(instruction_t*,uint8_t*,symtab_t**);
+void print_operand(instruction_t*,uint8_t*,const symtab_index_t*);
 uint8_t print_pseudo_operand(instruction_t*);
 void print_excess_bytes(instruction_t*,uint8_t*);
+void print_xref(xref_t*,inst_list_t*,uint8_t*,const symtab_index_t*,
+		uint16_t);
 #endif
@@ -13,9 +13,12 @@
 #include <inttypes.h>           /* allows PRIu8 */
 #include <string.h>		/* strcat */
 #include <stdlib.h>		/* malloc */
+#include <ctype.h>		/* isprint */
 
 #include "../main/debug.h"      /* DEBUG statements */
 #include "print-interp.h"	/* header file */
+#include "trace.h"		/* binary trace */
+#include "../interp/flags.h"	/* condition codes */
 /* ************************************************************************* *
  * Local function prototypes                                                 *
  * ************************************************************************* */
@@ -49,6 +52,106 @@ void print_interpreter(cpu_t* pep8)
     print_instruction_register(pep8);
 }
 
+/* ************************************************************************* *
+ * Purpose: Print whatever the trace level wants once the run is over        *
+ *                                                                           *
+ * Parameters:                                                               *
+ *     pep8- the cpu after the last instruction                              *
+ * ************************************************************************* */
+void print_end_of_run(cpu_t* pep8)
+{
+    if (pep8->trace == TRACE_FINAL)
+	print_interpreter(pep8);
+    else if (pep8->trace == TRACE_BINARY)
+	trace_record_end();
+    //stylistically since you have reached the last instruction
+    if (pep8->trace == TRACE_FULL || pep8->trace == TRACE_FINAL)
+	print_divider();
+}
+
+/* ************************************************************************* *
+ * Purpose: Print a value DECO wrote                                         *
+ *                                                                           *
+ * Parameters:                                                               *
+ *     pep8- the cpu, for its trace level                                    *
+ *     result- the decimal value                                             *
+ *                                                                           *
+ * Notes:                                                                    *
+ *     The full trace labels it; TRACE_OUTPUTS prints it as the program      *
+ *     would, with nothing around it.                                        *
+ * ************************************************************************* */
+void print_decimal_output(cpu_t* pep8,int16_t result)
+{
+    if (pep8->trace == TRACE_FULL)
+	printf("  Output: %d\n",result);
+    else if (pep8->trace == TRACE_OUTPUTS)
+	printf("%d",result);
+    else if (pep8->trace == TRACE_BINARY)
+	trace_record_output(TRACE_OUTPUT_DEC,result);
+}
+
+/* ************************************************************************* *
+ * Purpose: Print a character CHARO wrote                                    *
+ *                                                                           *
+ * Parameters:                                                               *
+ *     pep8- the cpu, for its trace level                                    *
+ *     character- the byte written                                           *
+ * ************************************************************************* */
+void print_character_output(cpu_t* pep8,uint8_t character)
+{
+    if (pep8->trace == TRACE_FULL)
+    {
+	if (isprint(character))
+	    printf("  Output '%c'\n",character);
+	else
+	    printf("  Output '\\x%02X'\n",character);
+    }
+    else if (pep8->trace == TRACE_OUTPUTS)
+	putchar(character);
+    else if (pep8->trace == TRACE_BINARY)
+	trace_record_output(TRACE_OUTPUT_CHAR,character);
+}
+
+/* ************************************************************************* *
+ * Purpose: Show the two bytes STr wrote                                     *
+ *                                                                           *
+ * Parameters:                                                               *
+ *     pep8- the cpu, for its trace level                                    *
+ *     address- where the most significant byte went                         *
+ *     most_sig_byte- the byte at address                                    *
+ *     least_sig_byte- the byte at address + 1                               *
+ * ************************************************************************* */
+void print_word_write(cpu_t* pep8,uint16_t address,uint8_t most_sig_byte,
+		      uint8_t least_sig_byte)
+{
+    if (pep8->trace == TRACE_FULL)
+    {
+	printf("  Mem[%04X] <-- 0x%04X\n",address,most_sig_byte);
+	printf("  MEM[%04X] <-- 0x%04X\n",address+1,least_sig_byte);
+    }
+    else if (pep8->trace == TRACE_BINARY)
+    {
+	trace_record_write(address,most_sig_byte);
+	trace_record_write(address+1,least_sig_byte);
+    }
+}
+
+/* ************************************************************************* *
+ * Purpose: Show the byte STBYTEr wrote                                      *
+ *                                                                           *
+ * Parameters:                                                               *
+ *     pep8- the cpu, for its trace level                                    *
+ *     address- where the byte went                                          *
+ *     value- the byte                                                       *
+ * ************************************************************************* */
+void print_byte_write(cpu_t* pep8,uint16_t address,uint8_t value)
+{
+    if (pep8->trace == TRACE_FULL)
+	printf("  Mem[%04X] <-- 0x%04X\n",address,value);
+    else if (pep8->trace == TRACE_BINARY)
+	trace_record_write(address,value);
+}
+
 /* ************************************************************************* *
  * Purpose: Print the status bits of pep8	 	                     *
  *                                                                           *
@@ -59,19 +162,19 @@ void print_status_bits(cpu_t* pep8)
 {
     printf("Status bits (NZVC)");
     printf("          ");
-    if (pep8->n)
+    if (flag_n(pep8))
 	printf("1 ");
     else
 	printf("0 ");
-    if (pep8->z)
+    if (flag_z(pep8))
         printf("1 ");
     else
         printf("0 ");
-    if (pep8->v)
+    if (flag_v(pep8))
         printf("1 ");
     else
         printf("0 ");
-    if (pep8->c)
+    if (flag_c(pep8))
         printf("1 ");
     else
         printf("0 ");
@@ -131,6 +234,40 @@ void print_instruction_register(cpu_t* pep8)
     printf("0x%06X\n",pep8->inst_reg);
 }
 
+/* ************************************************************************* *
+ * Purpose: Print why the interpreter stopped on an instruction              *
+ *                                                                           *
+ * Parameters:                                                               *
+ *     kind- TRACE_ERROR_INSTRUCTION, TRACE_ERROR_ADDR_MODE or               *
+ *           TRACE_ERROR_INVALID_MODE                                        *
+ *     mnem- the instruction's mnemonic_t                                    *
+ *     mode- its addressing mode                                             *
+ *                                                                           *
+ * Notes:                                                                    *
+ *     Only prints; the print_unsupported_* and print_invalid_* functions    *
+ *     below exit after it, and trace_decode replays it from a trace.        *
+ * ************************************************************************* */
+void print_interp_error(uint8_t kind,uint8_t mnem,uint8_t mode)
+{
+    static const char* const ADDR_MODES[8] = {
+	"Immediate", "Direct", "Indirect", "Stack-relative",
+	"Stack_relative deferred", "Indexed", "Stack-indexed",
+	"Stack-indexed deferred"
+    };
+    if (kind == TRACE_ERROR_INSTRUCTION)
+	printf("The given instruction \"%s\" is not supported by this"
+	       " interpreter.  Exiting program \n",MNEMONICS[mnem]);
+    else if (kind == TRACE_ERROR_ADDR_MODE) //immediate and direct always work
+	printf("The given instruction %s's addressing mode: %s is not supported by"
+	       "this interpreter. Exiting program \n",
+	       MNEMONICS[mnem],mode >= 2 && mode <= 7 ? ADDR_MODES[mode]
+						      : "Invalid");
+    else
+	printf("The given instruction %s's addressing mode: %s is not valid for"
+	       "this instruction\n",MNEMONICS[mnem],
+	       mode <= 7 ? ADDR_MODES[mode] : "(null)");
+}
+
 /* ************************************************************************* *
  * Purpose: Print an error message corresponding to function title           *
  *                                                                           *
@@ -139,8 +276,8 @@ void print_instruction_register(cpu_t* pep8)
  * ************************************************************************* */
 void print_unsupported_instruction(instruction_t* inst)
 {
-    printf("The given instruction \"%s\" is not supported by this"
-	   " interpreter.  Exiting program \n",MNEMONICS[inst->mnem]);
+    trace_record_error(TRACE_ERROR_INSTRUCTION,inst->mnem,inst->addr_mode);
+    print_interp_error(TRACE_ERROR_INSTRUCTION,inst->mnem,inst->addr_mode);
     exit(0);
 }
 
@@ -152,24 +289,8 @@ void print_unsupported_instruction(instruction_t* inst)
  * ************************************************************************* */
 void print_unsupported_addr_mode(instruction_t* inst)
 {
-    char* addr_mode = NULL;
-    if (inst->addr_mode == 0x02)
-	addr_mode = "Indirect";
-    else if (inst->addr_mode == 0x03)
-        addr_mode = "Stack-relative";
-    else if (inst->addr_mode == 0x04)
-        addr_mode = "Stack_relative deferred";
-    else if (inst->addr_mode == 0x05)
-        addr_mode = "Indexed";
-    else if (inst->addr_mode == 0x06)
-        addr_mode = "Stack-indexed";
-    else if (inst->addr_mode == 0x07)
-        addr_mode = "Stack-indexed deferred";
-    else
-	addr_mode = "Invalid";
-    printf("The given instruction %s's addressing mode: %s is not supported by"
-	   "this interpreter. Exiting program \n",
-	     MNEMONICS[inst->mnem],addr_mode);
+    trace_record_error(TRACE_ERROR_ADDR_MODE,inst->mnem,inst->addr_mode);
+    print_interp_error(TRACE_ERROR_ADDR_MODE,inst->mnem,inst->addr_mode);
     exit(0);
 }
 
@@ -181,27 +302,7 @@ void print_unsupported_addr_mode(instruction_t* inst)
  * ************************************************************************* */
 void print_invalid_addr_mode(instruction_t* inst)
 {
-    char* addr_mode = NULL;
-    if (inst->addr_mode == 0x00)
-        addr_mode = "Immediate";
-    else if (inst->addr_mode == 0x01)
-        addr_mode = "Direct";
-    else if (inst->addr_mode == 0x02)
-        addr_mode = "Indirect";
-    else if (inst->addr_mode == 0x03)
-        addr_mode = "Stack-relative";
-    else if (inst->addr_mode == 0x04)
-        addr_mode = "Stack_relative deferred";
-    else if (inst->addr_mode == 0x05)
-        addr_mode = "Indexed";
-    else if (inst->addr_mode == 0x06)
-        addr_mode = "Stack-indexed";
-    else if (inst->addr_mode == 0x07)
-        addr_mode = "Stack-indexed deferred";
-    printf("The given instruction %s's addressing mode: %s is not valid for"
-           "this instruction\n",MNEMONICS[inst->mnem],addr_mode);
+    trace_record_error(TRACE_ERROR_INVALID_MODE,inst->mnem,inst->addr_mode);
+    print_interp_error(TRACE_ERROR_INVALID_MODE,inst->mnem,inst->addr_mode);
     exit(1);
 }
-
-
-
@@ -26,7 +26,13 @@ void print_accumulator(cpu_t*);
 void print_index_register(cpu_t*);
 void print_program_counter(cpu_t*);
 void print_instruction_register(cpu_t*);
+void print_end_of_run(cpu_t*);
+void print_decimal_output(cpu_t*,int16_t);
+void print_character_output(cpu_t*,uint8_t);
+void print_word_write(cpu_t*,uint16_t,uint8_t,uint8_t);
+void print_byte_write(cpu_t*,uint16_t,uint8_t);
 
+void print_interp_error(uint8_t,uint8_t,uint8_t);
 void print_unsupported_instruction(instruction_t*);
 void print_unsupported_addr_mode(instruction_t*);
 void print_invalid_addr_mode(instruction_t*);
@@ -0,0 +1,448 @@
+/* ************************************************************************* *
+ * print-records.c                                                           *
+ * ---------------                                                           *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  The disassembly as records for other programs (-f).  JSON      *
+ *            Lines gives one object per listing line; the packed format     *
+ *            gives fixed-size binary records (layout in print-records.h)    *
+ *            that can be mapped and indexed without parsing.  Both are      *
+ *            written straight from the instruction list, one buffered       *
+ *            block at a time, and say the same things the text listing      *
+ *            says: the same lines, labels, mnemonics and operands.          *
+ * ************************************************************************* */
+
+/* ************************************************************************* *
+ * Library includes here.                                                    *
+ * ************************************************************************* */
+
+#include <stdio.h>              /* standard I/O */
+#include <stdint.h>             /* uint8_t, uint32_t */
+#include <stdlib.h>             /* malloc */
+#include <string.h>             /* memcpy, strlen */
+
+#include "print-records.h"	/* header file */
+#include "../symbol/sym.h"	/* SYMTYPES */
+
+/* ************************************************************************* *
+ * Global variable declarations                                              *
+ * ************************************************************************* */
+#define RECORD_BUFFER_SIZE (1 << 16) //records are written in 64 KB blocks
+
+const char *FORMATS[] = {
+    "text", "json", "packed"
+};
+
+static char buffer[RECORD_BUFFER_SIZE]; //output not yet written to stdout
+static size_t buffered = 0; //bytes in buffer
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+//addressing modes by number, as the listing shows them after the comma
+static const char *MODES[] = {
+    "i", "d", "n", "s", "sf", "x", "sx", "sxf"
+};
+static const char *SINGLE_DIGIT_MODES[] = {
+    "i", "x"
+};
+
+/* ************************************************************************* *
+ * Output buffer helpers, as in print-disasm.c                               *
+ * ************************************************************************* */
+static void flush_buffer()
+{
+    fwrite(buffer,1,buffered,stdout);
+    buffered = 0;
+}
+
+static void put_bytes(const void* bytes,size_t length)
+{
+    if (buffered + length > RECORD_BUFFER_SIZE)
+    {
+	flush_buffer();
+	if (length > RECORD_BUFFER_SIZE) //too big to buffer, write it now
+	{
+	    fwrite(bytes,1,length,stdout);
+	    return;
+	}
+    }
+    memcpy(buffer + buffered,bytes,length);
+    buffered += length;
+}
+
+static void put_char(char c)
+{
+    if (buffered == RECORD_BUFFER_SIZE)
+	flush_buffer();
+    buffer[buffered++] = c;
+}
+
+static void put_string(const char* string)
+{
+    put_bytes(string,strlen(string));
+}
+
+static void put_decimal(uint32_t value)
+{
+    char text[10];
+    int digits = 0;
+    do
+    {
+	text[sizeof(text) - ++digits] = '0' + value % 10;
+	value /= 10;
+    } while (value != 0);
+    put_bytes(text + sizeof(text) - digits,digits);
+}
+
+/* ************************************************************************* *
+ * Little-endian field helpers, as in trace.c                                *
+ * ************************************************************************* */
+static void put16(uint8_t* at,uint16_t value)
+{
+    at[0] = value;
+    at[1] = value >> 8;
+}
+
+static void put32(uint8_t* at,uint32_t value)
+{
+    put16(at,value);
+    put16(at + 2,value >> 16);
+}
+
+/* ************************************************************************* *
+ * Purpose: Convert a format name given to -f to a format_t                  *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      int: the format_t, or -1 if the name is not a format                 *
+ * ************************************************************************* */
+int get_format_by_id(const char* name)
+{
+    int index = 0;
+    for (index = 0; index < NUMBER_OF_FORMATS; index++)
+    {
+	if (strcmp(name,FORMATS[index]) == 0)
+	    return index;
+    }
+    return -1;
+}
+
+/* ************************************************************************* *
+ * Purpose: Tell whether a line is a .ASCII, .BLOCK or .WORD directive       *
+ * ************************************************************************* */
+static _Bool is_directive(instruction_t* inst)
+{
+    return inst->symb != NULL && inst->symb->type != LINE;
+}
+
+/* ************************************************************************* *
+ * Purpose: Count the bytes a line covers, as determine_instructions stepped *
+ * ************************************************************************* */
+static uint32_t line_length(instruction_t* inst)
+{
+    if (is_directive(inst) && inst->symb->type == ASCII)
+	return inst->ascii_bytes;
+    if (is_directive(inst) && inst->symb->type == BLOCK)
+	return inst->symb->block_length;
+    if (is_directive(inst)) //WORD
+	return 2;
+    return inst->unary ? 1 : 3;
+}
+
+/* ************************************************************************* *
+ * Purpose: Find the operand as a number                                     *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      uint16_t: the operand specifier, the .WORD value, the .BLOCK length, *
+ *                or the .ASCII length without its zero byte; 0 if unary     *
+ * ************************************************************************* */
+static uint16_t operand_value(instruction_t* inst)
+{
+    if (is_directive(inst) && inst->symb->type == ASCII)
+	return inst->ascii_bytes - 1;
+    if (is_directive(inst) && inst->symb->type == BLOCK)
+	return inst->symb->block_length;
+    if (is_directive(inst)) //WORD: the first two bytes
+	return (inst->inst_spec << 8) | (inst->op_spec >> 8);
+    return inst->unary ? 0 : inst->op_spec;
+}
+
+/* ************************************************************************* *
+ * Purpose: Find the symbol an instruction's operand names, the same one     *
+ *          print_operand prints                                             *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      symbol_t*: the symbol, or NULL if the operand is printed as a number *
+ * ************************************************************************* */
+static symbol_t* operand_symbol(instruction_t* inst,
+				const symtab_index_t* symbols)
+{
+    symbol_t* symbol = NULL;
+    if (!is_directive(inst) && !inst->unary)
+	symbol = symtab_lookup(symbols,inst->op_spec);
+    if (symbol != NULL && symbol->label == 0)
+	symbol = NULL;
+    return symbol;
+}
+
+/* ************************************************************************* *
+ * Purpose: Find the addressing mode as the listing shows it                 *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      const char*: "i", "d", ..., "sxf", or NULL if there is none          *
+ * ************************************************************************* */
+static const char* mode_name(instruction_t* inst)
+{
+    if (inst->addr_mode == DNE)
+	return NULL;
+    if (inst->single_digit_addressing)
+	return inst->addr_mode <= 0x01 ? SINGLE_DIGIT_MODES[inst->addr_mode]
+				       : NULL;
+    return inst->addr_mode <= 0x07 ? MODES[inst->addr_mode] : NULL;
+}
+
+/* ************************************************************************* *
+ * Purpose: Print a JSON string, or null                                     *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      text: the bytes, or NULL for null                                    *
+ *      length: how many                                                     *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      Quotes, backslashes, control characters and bytes past 0x7E are      *
+ *      escaped, so a .ASCII string holding any bytes is still valid JSON    *
+ *      (a byte past 0x7F reads back as the Latin-1 character).              *
+ * ************************************************************************* */
+static void put_json_string(const char* text,size_t length)
+{
+    size_t i = 0;
+    if (text == NULL)
+    {
+	put_string("null");
+	return;
+    }
+    put_char('"');
+    for (i = 0; i < length; i++)
+    {
+	uint8_t c = text[i];
+	if (c == '"' || c == '\\')
+	{
+	    put_char('\\');
+	    put_char(c);
+	}
+	else if (c < 0x20 || c > 0x7E)
+	{
+	    put_string("\\u00");
+	    put_char(HEX_DIGITS[c >> 4]);
+	    put_char(HEX_DIGITS[c & 0xF]);
+	}
+	else
+	    put_char(c);
+    }
+    put_char('"');
+}
+
+/* ************************************************************************* *
+ * Purpose: Print a label as a JSON string, or null if there is none         *
+ * ************************************************************************* */
+static void put_json_label(const symtab_index_t* symbols,symbol_t* symbol)
+{
+    const char* label = symbol != NULL ? symbol_label(symbols->symtab,symbol)
+				       : NULL;
+    put_json_string(label,label != NULL ? strlen(label) : 0);
+}
+
+/* ************************************************************************* *
+ * Purpose: Print the disassembly as JSON Lines                              *
+ *                                                                           *
+ * Parameters:                                                               *
+ *     instructions -- the list of instructions to print out                 *
+ *     memory -- the array of bytes in memory                                *
+ *     mem_length -- the number of bytes in memory                           *
+ *     symbols -- the symbol table by address, or NULL if there is none      *
+ *                                                                           *
+ * Notes:                                                                    *
+ *     Each line is one object:                                              *
+ *       {"addr":3,"bytes":"390011","label":null,"mnemonic":"DECO",          *
+ *        "operand":17,"operand_label":"num","mode":"d","symtype":null}      *
+ *     addr and the operand are numbers; the operand of a .ASCII line is     *
+ *     its text without the zero byte, of a unary instruction null.  bytes   *
+ *     covers the whole line, so a long .ASCII or .BLOCK is one object.      *
+ *     label and symtype come from the symbol at the address, if any.        *
+ * ************************************************************************* */
+void print_json(inst_list_t* instructions,uint8_t* memory,int mem_length,
+		const symtab_index_t* symbols)
+{
+    size_t i = 0;
+    uint32_t k = 0;
+    for (i = 0; i < instructions->count; i++)
+    {
+	instruction_t* inst = &instructions->items[i];
+	uint32_t length = line_length(inst);
+	const char* mode = mode_name(inst);
+
+	put_string("{\"addr\":");
+	put_decimal(inst->addr);
+	put_string(",\"bytes\":\"");
+	for (k = inst->addr; k < inst->addr + length; k++)
+	{
+	    uint8_t byte = k < (uint32_t)mem_length ? memory[k] : 0;
+	    put_char(HEX_DIGITS[byte >> 4]);
+	    put_char(HEX_DIGITS[byte & 0xF]);
+	}
+	put_string("\",\"label\":");
+	put_json_label(symbols,inst->symb);
+	put_string(",\"mnemonic\":\"");
+	put_string(MNEMONICS[inst->mnem]);
+	put_string("\",\"operand\":");
+	if (is_directive(inst) && inst->symb->type == ASCII)
+	    put_json_string((const char*)memory + inst->addr,
+			    operand_value(inst));
+	else if (!is_directive(inst) && inst->unary)
+	    put_string("null");
+	else
+	    put_decimal(operand_value(inst));
+	put_string(",\"operand_label\":");
+	put_json_label(symbols,operand_symbol(inst,symbols));
+	put_string(",\"mode\":");
+	put_json_string(mode,mode != NULL ? strlen(mode) : 0);
+	put_string(",\"symtype\":");
+	if (inst->symb != NULL)
+	{
+	    put_char('"');
+	    put_string(SYMTYPES[inst->symb->type]);
+	    put_char('"');
+	}
+	else
+	    put_string("null");
+	put_string("}\n");
+    }
+    flush_buffer();
+}
+
+/* ************************************************************************* *
+ * Purpose: Give a label its place in the packed string table                *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      symbols: the symbol table by address                                 *
+ *      symbol: the symbol, or NULL                                          *
+ *      address: where the symbol table index has it                         *
+ *      offsets: the string table offset of each address's label, 0 if not   *
+ *               added yet                                                   *
+ *      strings_length: the string table length so far, grown by the label   *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      uint32_t: the label's offset, 0 if there is no label                 *
+ * ************************************************************************* */
+static uint32_t label_offset(const symtab_index_t* symbols,
+			     symbol_t* symbol,uint16_t address,
+			     uint32_t* offsets,uint32_t* strings_length)
+{
+    if (symbol == NULL || symbol->label == 0)
+	return 0;
+    if (offsets[address] == 0)
+    {
+	offsets[address] = *strings_length;
+	*strings_length += strlen(symbol_label(symbols->symtab,symbol)) + 1;
+    }
+    return offsets[address];
+}
+
+/* ************************************************************************* *
+ * Purpose: Write the disassembly as packed binary records                   *
+ *                                                                           *
+ * Parameters:                                                               *
+ *     instructions -- the list of instructions to write out                 *
+ *     memory -- the array of bytes in memory                                *
+ *     mem_length -- the number of bytes in memory                           *
+ *     origin -- the address the image is loaded at, for the header          *
+ *     symbols -- the symbol table by address, or NULL if there is none      *
+ *                                                                           *
+ * Returns:                                                                  *
+ *    0 - if success                                                         *
+ *    1 - if failure                                                         *
+ *                                                                           *
+ * Notes:                                                                    *
+ *     The layout is in print-records.h.  Every symbol can be found by its   *
+ *     address in the index, so a label is stored once however many lines    *
+ *     name it; the first pass over the list lays out the string table and   *
+ *     the second writes the records.                                        *
+ * ************************************************************************* */
+int print_packed(inst_list_t* instructions,uint8_t* memory,int mem_length,
+		 uint16_t origin,const symtab_index_t* symbols)
+{
+    uint32_t* offsets = calloc(SYMTAB_INDEX_SIZE,sizeof(uint32_t));
+    uint32_t strings_length = 1; //the empty label at offset 0
+    uint8_t header[PACKED_HEADER_SIZE];
+    uint8_t record[PACKED_RECORD_SIZE];
+    size_t i = 0;
+    if (offsets == NULL)
+    {
+	printf("Error No memory allocated");
+	return 1;
+    }
+
+    //lay out the string table
+    for (i = 0; i < instructions->count; i++)
+    {
+	instruction_t* inst = &instructions->items[i];
+	symbol_t* symbol = operand_symbol(inst,symbols);
+	label_offset(symbols,inst->symb,inst->addr,offsets,&strings_length);
+	if (symbol != NULL)
+	    label_offset(symbols,symbol,inst->op_spec,offsets,
+			 &strings_length);
+    }
+
+    memset(header,0,sizeof(header));
+    memcpy(header,PACKED_MAGIC,PACKED_MAGIC_SIZE);
+    put32(header + 8,instructions->count);
+    put32(header + 12,mem_length);
+    put32(header + 16,strings_length);
+    put16(header + 20,origin);
+    put_bytes(header,PACKED_HEADER_SIZE);
+
+    for (i = 0; i < instructions->count; i++)
+    {
+	instruction_t* inst = &instructions->items[i];
+	symbol_t* symbol = operand_symbol(inst,symbols);
+	memset(record,0,sizeof(record));
+	put16(record,inst->addr);
+	put16(record + 2,line_length(inst));
+	put16(record + 4,operand_value(inst));
+	record[6] = inst->inst_spec;
+	record[7] = inst->mnem;
+	record[8] = inst->addr_mode;
+	record[9] = inst->symb != NULL ? inst->symb->type : DNE;
+	record[10] = (inst->unary ? PACKED_UNARY : 0) |
+		     (inst->single_digit_addressing ? PACKED_SINGLE_DIGIT : 0);
+	put32(record + 12,label_offset(symbols,inst->symb,inst->addr,offsets,
+				       &strings_length));
+	if (symbol != NULL)
+	    put32(record + 16,label_offset(symbols,symbol,inst->op_spec,
+					   offsets,&strings_length));
+	put_bytes(record,PACKED_RECORD_SIZE);
+    }
+
+    put_bytes(memory,mem_length);
+
+    //the string table, in the order the first pass laid it out
+    put_char('\0');
+    for (i = 0; i < instructions->count; i++)
+    {
+	instruction_t* inst = &instructions->items[i];
+	symbol_t* symbol = operand_symbol(inst,symbols);
+	if (inst->symb != NULL && inst->symb->label != 0 &&
+	    offsets[inst->addr] != 0)
+	{
+	    const char* label = symbol_label(symbols->symtab,inst->symb);
+	    put_bytes(label,strlen(label) + 1);
+	    offsets[inst->addr] = 0; //written
+	}
+	if (symbol != NULL && offsets[inst->op_spec] != 0)
+	{
+	    const char* label = symbol_label(symbols->symtab,symbol);
+	    put_bytes(label,strlen(label) + 1);
+	    offsets[inst->op_spec] = 0;
+	}
+    }
+    flush_buffer();
+    free(offsets);
+    return 0;
+}
@@ -0,0 +1,69 @@
+#ifndef __PEP8_RECORDS__
+#define __PEP8_RECORDS__
+
+/* ************************************************************************* *
+ * print-records.h                                                           *
+ * ---------------                                                           *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Header file for print-records.c                                *
+ * ************************************************************************* */
+
+
+/* ************************************************************************* *
+ * Library includes here. If none needed, delete this comment.               *
+ * ************************************************************************* */
+#include "../disasm/disasm.h"          /* disasm structs and types */
+
+/* Listing formats selectable with -f */
+typedef enum format {
+    FORMAT_TEXT, //print_disassembler: the column-aligned listing
+    FORMAT_JSON, //print_json: one JSON object per line
+    FORMAT_PACKED //print_packed: fixed-size binary records
+} format_t;
+
+#define NUMBER_OF_FORMATS (FORMAT_PACKED + 1)
+
+/* ************************************************************************* *
+ * Packed listing layout (all fields little-endian):                         *
+ *   header, PACKED_HEADER_SIZE bytes:                                       *
+ *      0  8    the bytes "PEP8DIS1"                                         *
+ *      8  u32  number of records                                            *
+ *     12  u32  image length                                                 *
+ *     16  u32  string table length                                          *
+ *     20  u16  origin                                                       *
+ *     22  u16  zero                                                         *
+ *   then one PACKED_RECORD_SIZE record per listing line:                    *
+ *      0  u16  address, as the listing shows it                             *
+ *      2  u16  number of bytes the line covers                              *
+ *      4  u16  operand: the operand specifier, the .WORD value, the .BLOCK  *
+ *              length, or the .ASCII length without its zero byte           *
+ *      6  u8   instruction specifier (first byte)                           *
+ *      7  u8   mnemonic, a mnemonic_t                                       *
+ *      8  u8   addressing mode, DNE if none                                 *
+ *      9  u8   symbol type, a symtype_t, DNE if the line has no symbol      *
+ *     10  u8   PACKED_* flags                                               *
+ *     11  u8   zero                                                         *
+ *     12  u32  label: offset into the string table, 0 if none               *
+ *     16  u32  operand label: offset into the string table, 0 if none       *
+ *   then the image, whose bytes the addresses index (bytes past its end     *
+ *   are zero), then the string table: zero-terminated labels, starting      *
+ *   with an empty one at offset 0.                                          *
+ * ************************************************************************* */
+#define PACKED_MAGIC "PEP8DIS1"
+#define PACKED_MAGIC_SIZE 8
+#define PACKED_HEADER_SIZE 24
+#define PACKED_RECORD_SIZE 20
+
+#define PACKED_UNARY        0x01	//no operand specifier
+#define PACKED_SINGLE_DIGIT 0x02	//the "a" addressing field, i or x
+
+/* Global constants defined in print-records.c */
+extern const char *FORMATS[];
+
+/* ************************************************************************* *
+ * Function prototypes here. Note that variable names are often omitted.     *
+ * ************************************************************************* */
+int get_format_by_id(const char*);
+void print_json(inst_list_t*,uint8_t*,int,const symtab_index_t*);
+int print_packed(inst_list_t*,uint8_t*,int,uint16_t,const symtab_index_t*);
+#endif
@@ -0,0 +1,316 @@
+/* ************************************************************************* *
+ * trace.c                                                                   *
+ * -------                                                                   *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Compact binary execution trace (-w) and its decoder (-d).      *
+ *            Each step is one fixed-size record (layout in trace.h), so a   *
+ *            long run costs a few dozen bytes per step instead of the ~200  *
+ *            bytes of formatted text, and nothing is formatted while the    *
+ *            program runs.                                                  *
+ * ************************************************************************* */
+
+
+/* ************************************************************************* *
+ * Library includes here.                                                    *
+ * ************************************************************************* */
+
+#include <stdio.h>              /* standard I/O */
+#include <stdint.h>             /* uint8_t, uint64_t */
+#include <stdbool.h>            /* bool types */
+#include <stdlib.h>             /* atexit */
+#include <string.h>             /* memcmp, memset */
+
+#include "trace.h"		/* header file */
+#include "print-interp.h"	/* print_interpreter */
+#include "../interp/flags.h"	/* condition codes */
+
+/* ************************************************************************* *
+ * Global variable declarations                                              *
+ * ************************************************************************* */
+#define TRACE_BUFFER_SIZE (1 << 16) //records are flushed in 64 KB writes
+
+static FILE* trace_file = NULL;
+static uint8_t buffer[TRACE_BUFFER_SIZE];
+static size_t buffered = 0;
+static uint8_t pending[TRACE_RECORD_SIZE]; //the step still being executed
+static bool have_pending = false;
+
+/* ************************************************************************* *
+ * Little-endian field helpers                                               *
+ * ************************************************************************* */
+static void put16(uint8_t* at,uint16_t value)
+{
+    at[0] = value;
+    at[1] = value >> 8;
+}
+
+static void put32(uint8_t* at,uint32_t value)
+{
+    put16(at,value);
+    put16(at + 2,value >> 16);
+}
+
+static uint16_t get16(const uint8_t* at)
+{
+    return at[0] | (at[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* at)
+{
+    return get16(at) | ((uint32_t)get16(at + 2) << 16);
+}
+
+/* ************************************************************************* *
+ * Purpose: Write out everything buffered so far                             *
+ * ************************************************************************* */
+static void flush_buffer()
+{
+    if (buffered > 0)
+	fwrite(buffer,1,buffered,trace_file);
+    buffered = 0;
+}
+
+/* ************************************************************************* *
+ * Purpose: Move a finished record into the write buffer                     *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      record: TRACE_RECORD_SIZE bytes                                      *
+ * ************************************************************************* */
+static void emit(const uint8_t* record)
+{
+    if (buffered + TRACE_RECORD_SIZE > TRACE_BUFFER_SIZE)
+	flush_buffer();
+    memcpy(buffer + buffered,record,TRACE_RECORD_SIZE);
+    buffered += TRACE_RECORD_SIZE;
+}
+
+/* ************************************************************************* *
+ * Purpose: Create the trace file and write its header                       *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      filename: where to write the trace                                   *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      0 - if success                                                       *
+ *      1 - if failure                                                       *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      trace_close is registered with atexit, so a run that stops on an     *
+ *      unsupported instruction still leaves a readable trace.               *
+ * ************************************************************************* */
+int trace_open(const char* filename)
+{
+    trace_file = fopen(filename,"wb");
+    if (trace_file == NULL)
+    {
+	printf("Cannot create trace file \"%s\"\n",filename);
+	return 1;
+    }
+    buffered = 0;
+    have_pending = false;
+    memcpy(buffer,TRACE_MAGIC,TRACE_MAGIC_SIZE);
+    buffered = TRACE_MAGIC_SIZE;
+    atexit(trace_close);
+    return 0;
+}
+
+/* ************************************************************************* *
+ * Purpose: Finish the last record and close the trace file                  *
+ * ************************************************************************* */
+void trace_close()
+{
+    if (trace_file == NULL)
+	return;
+    if (have_pending)
+	emit(pending);
+    have_pending = false;
+    flush_buffer();
+    fclose(trace_file);
+    trace_file = NULL;
+}
+
+/* ************************************************************************* *
+ * Purpose: Start the record of a step; called where the text trace would    *
+ *          print the cpu                                                    *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      pep8: the cpu after fetch, decode and increment                      *
+ *      step: the step number                                                *
+ * ************************************************************************* */
+void trace_record_step(cpu_t* pep8,uint64_t step)
+{
+    if (have_pending)
+	emit(pending);
+    memset(pending,0,TRACE_RECORD_SIZE);
+    put32(pending,step);
+    put32(pending + 4,step >> 32);
+    put16(pending + 8,pep8->pc);
+    put32(pending + 10,pep8->inst_reg & 0xFFFFFF);
+    put16(pending + 14,pep8->accum);
+    put16(pending + 16,pep8->x);
+    pending[18] = (flag_n(pep8) << 3) | (flag_z(pep8) << 2) |
+	(flag_v(pep8) << 1) | flag_c(pep8);
+    have_pending = true;
+}
+
+/* ************************************************************************* *
+ * Purpose: Add a byte the current step stored to its record                 *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      address: where the byte went                                         *
+ *      value: the byte                                                      *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      A word store calls this for address and then address + 1.            *
+ * ************************************************************************* */
+void trace_record_write(uint16_t address,uint8_t value)
+{
+    uint8_t count = pending[19] & TRACE_WRITE_MASK;
+    if (count == 0)
+	put16(pending + 20,address);
+    if (count < 2)
+    {
+	pending[22 + count] = value;
+	pending[19] = (pending[19] & ~TRACE_WRITE_MASK) | (count + 1);
+    }
+}
+
+/* ************************************************************************* *
+ * Purpose: Add what DECO or CHARO wrote to the current step's record        *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      kind: TRACE_OUTPUT_DEC or TRACE_OUTPUT_CHAR                          *
+ *      value: the decimal value or the character                            *
+ * ************************************************************************* */
+void trace_record_output(uint8_t kind,uint16_t value)
+{
+    pending[19] |= kind;
+    put16(pending + 24,value);
+}
+
+/* ************************************************************************* *
+ * Purpose: Mark that the run reached its end (STOP)                         *
+ * ************************************************************************* */
+void trace_record_end()
+{
+    uint8_t record[TRACE_RECORD_SIZE] = {0};
+    if (have_pending)
+	emit(pending);
+    have_pending = false;
+    record[19] = TRACE_END;
+    emit(record);
+}
+
+/* ************************************************************************* *
+ * Purpose: Mark that the run stopped on an instruction it cannot run        *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      kind: a TRACE_ERROR_* kind                                           *
+ *      mnem: the instruction's mnemonic_t                                   *
+ *      mode: its addressing mode                                            *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      Does nothing unless -w is writing a trace, since the print_*         *
+ *      functions that exit call it on every run.                            *
+ * ************************************************************************* */
+void trace_record_error(uint8_t kind,uint8_t mnem,uint8_t mode)
+{
+    uint8_t record[TRACE_RECORD_SIZE] = {0};
+    if (trace_file == NULL)
+	return;
+    if (have_pending)
+	emit(pending);
+    have_pending = false;
+    record[19] = TRACE_ERROR;
+    record[20] = mnem;
+    record[21] = mode;
+    record[22] = kind;
+    emit(record);
+}
+
+/* ************************************************************************* *
+ * Purpose: Print a binary trace as the text the full trace would have shown *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      filename: the trace written with -w                                  *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      0 - if success                                                       *
+ *      1 - if failure                                                       *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      The output is byte-for-byte what -l full prints for the same run,    *
+ *      including the message a run that stops on an instruction it cannot   *
+ *      run ends with.                                                       *
+ * ************************************************************************* */
+int trace_decode(const char* filename)
+{
+    uint8_t record[TRACE_RECORD_SIZE];
+    char magic[TRACE_MAGIC_SIZE];
+    FILE* fp = fopen(filename,"rb");
+    if (fp == NULL)
+    {
+	printf("File \"%s\" does not exist\n",filename);
+	return 1;
+    }
+    setvbuf(fp,NULL,_IOFBF,TRACE_BUFFER_SIZE);
+    if (fread(magic,1,TRACE_MAGIC_SIZE,fp) != TRACE_MAGIC_SIZE ||
+	memcmp(magic,TRACE_MAGIC,TRACE_MAGIC_SIZE) != 0)
+    {
+	printf("\"%s\" is not a pep8 trace file\n",filename);
+	fclose(fp);
+	return 1;
+    }
+
+    cpu_t pep8 = {0};
+    pep8.trace = TRACE_FULL;
+    while (fread(record,1,TRACE_RECORD_SIZE,fp) == TRACE_RECORD_SIZE)
+    {
+	uint8_t events = record[19];
+	if (events & TRACE_END)
+	{
+	    print_end_of_run(&pep8);
+	    break;
+	}
+	if (events & TRACE_ERROR)
+	{
+	    //the output instructions divide before they check the mode
+	    if (record[20] == DECO || record[20] == CHARO ||
+		(record[20] >= STA && record[20] <= STBYTEX))
+		print_divider();
+	    print_interp_error(record[22],record[20],record[21]);
+	    break;
+	}
+
+	pep8.pc = get16(record + 8);
+	pep8.inst_reg = get32(record + 10);
+	pep8.accum = get16(record + 14);
+	pep8.x = get16(record + 16);
+	flags_set_all(&pep8,(record[18] >> 3) & 1,(record[18] >> 2) & 1,
+		      (record[18] >> 1) & 1,record[18] & 1);
+	print_interpreter(&pep8);
+
+	if (events & TRACE_WRITE_MASK)
+	{
+	    print_divider();
+	    if ((events & TRACE_WRITE_MASK) == 2)
+		print_word_write(&pep8,get16(record + 20),record[22],
+				 record[23]);
+	    else
+		print_byte_write(&pep8,get16(record + 20),record[22]);
+	}
+	if (events & TRACE_OUTPUT_DEC)
+	{
+	    print_divider();
+	    print_decimal_output(&pep8,get16(record + 24));
+	}
+	if (events & TRACE_OUTPUT_CHAR)
+	{
+	    print_divider();
+	    print_character_output(&pep8,get16(record + 24));
+	}
+    }
+
+    fclose(fp);
+    return 0;
+}
@@ -0,0 +1,57 @@
+#ifndef __TRACE__
+#define __TRACE__
+
+/* ************************************************************************* *
+ * trace.h                                                                   *
+ * -------                                                                   *
+ *  Author:   David Johnson                                                  *
+ *  Purpose:  Header file for trace.c                                        *
+ * ************************************************************************* */
+
+#include "../interp/interp.h"		/* cpu_t */
+
+/* ************************************************************************* *
+ * Binary trace file layout (all fields little-endian):                      *
+ *   header: the 8 bytes "PEP8TRC1"                                          *
+ *   then one TRACE_RECORD_SIZE record per step:                             *
+ *      0  u64  step number, from 0                                          *
+ *      8  u16  PC (after increment, as the text trace shows it)             *
+ *     10  u32  IR in the low 24 bits                                        *
+ *     14  u16  A                                                            *
+ *     16  u16  X                                                            *
+ *     18  u8   NZVC in bits 3..0                                            *
+ *     19  u8   events, see the TRACE_* bits below                           *
+ *     20  u16  address of the memory write                                  *
+ *     22  u8   byte written at that address                                 *
+ *     23  u8   byte written at address + 1 (word writes only)               *
+ *     24  u16  value DECO or CHARO wrote                                    *
+ *   and, if the run reached its end, a record whose events are TRACE_END,   *
+ *   or, if it stopped on an instruction it cannot run, one whose events     *
+ *   are TRACE_ERROR and whose bytes 20, 21 and 22 hold the instruction's    *
+ *   mnemonic_t, its addressing mode and a TRACE_ERROR_* kind.               *
+ * ************************************************************************* */
+#define TRACE_MAGIC "PEP8TRC1"
+#define TRACE_MAGIC_SIZE 8
+#define TRACE_RECORD_SIZE 26
+
+#define TRACE_WRITE_MASK  0x03	//number of bytes written, 0..2
+#define TRACE_OUTPUT_DEC  0x04	//DECO wrote the output value
+#define TRACE_OUTPUT_CHAR 0x08	//CHARO wrote the output value
+#define TRACE_ERROR       0x40	//the run stopped on an error
+#define TRACE_END         0x80	//the run ended normally
+
+#define TRACE_ERROR_INSTRUCTION  0	//instruction is not supported
+#define TRACE_ERROR_ADDR_MODE    1	//addressing mode is not supported
+#define TRACE_ERROR_INVALID_MODE 2	//addressing mode is not valid for it
+
+/* Prototypes */
+int trace_open(const char*);
+void trace_close();
+void trace_record_step(cpu_t*,uint64_t);
+void trace_record_write(uint16_t,uint8_t);
+void trace_record_output(uint8_t,uint16_t);
+void trace_record_end();
+void trace_record_error(uint8_t,uint8_t,uint8_t);
+int trace_decode(const char*);
+
+#endif
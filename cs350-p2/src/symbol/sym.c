@@ -19,6 +19,11 @@
 #include <inttypes.h>           /* declares PRIu8 */
 #include <string.h>             /* allows strtok */
 #include <ctype.h>              /* allows "is" functions */
+#include <limits.h>             /* LONG_MAX */
+#include <fcntl.h>              /* open */
+#include <unistd.h>             /* close */
+#include <sys/stat.h>           /* fstat */
+#include <sys/mman.h>           /* mmap */
 
 #include "../main/debug.h"      /* DEBUG statements */
 #include "../disasm/disasm.h"   /* symtab_t */
@@ -30,6 +35,14 @@
 /* ************************************************************************* *
  * Global variable declarations                                              *
  * ************************************************************************* */
+#define IS_SYMLIST_SPACE(c) ((c) == ' ' || (c) == '\t' || (c) == '\r')
+#define MAX_SYMLIST_TOKENS 5 //a BLOCK's four items, and one more
+
+/* One item on a symlist line, pointing into the mapped file */
+typedef struct token {
+    const char* at;
+    size_t length;
+} token_t;
 
 /* ************************************************************************* *
  * Purpose: Convert a string to UpperCase                                    *
@@ -115,9 +128,10 @@ symtype_t get_symtype_by_id(char * code)
  *									     *
  * Returns: 1 in all cases since this is just an error message 		     *
  * ************************************************************************* */
-int print_error_symtab(const char* filename,uint8_t error_code)
+int print_error_symtab(const char* filename,uint8_t error_code,unsigned line)
 {
-    printf("Symbol file \"%s\" is illegally formatted\n",filename);
+    printf("Symbol file \"%s\" is illegally formatted on line %u\n",filename,
+	   line);
     if (error_code == 1) //letters only
 	printf("Your symbol type contained characters that were not letters\n");
     if (error_code == 2) //not one of the 4 symbol types
@@ -134,108 +148,465 @@ int print_error_symtab(const char* filename,uint8_t error_code)
     return 1;
 }
 
+/* ************************************************************************* *
+ * Purpose: Tell whether every character of a token passes a ctype test,     *
+ *          as letters_only and numbers_only do for a whole string           *
+ * ************************************************************************* */
+static _Bool token_is(const token_t* token,int (*test)(int))
+{
+    size_t i = 0;
+    for (i = 0; i < token->length; i++)
+    {
+	if (!test((unsigned char)token->at[i]))
+	    return false;
+    }
+    return true;
+}
+
+/* ************************************************************************* *
+ * Purpose: Read a token's value the way atoi and strtol do: an optional     *
+ *          sign, then digits up to the first character that is not one.     *
+ *          A value too big for a long is clamped, as strtol clamps it.      *
+ * ************************************************************************* */
+static long token_value(const token_t* token)
+{
+    size_t i = 0;
+    long value = 0;
+    _Bool negative = false;
+    if (token->length > 0 && (token->at[0] == '-' || token->at[0] == '+'))
+	negative = token->at[i++] == '-';
+    for (; i < token->length && isdigit((unsigned char)token->at[i]); i++)
+    {
+	int digit = token->at[i] - '0';
+	if (value > (LONG_MAX - digit) / 10)
+	    return negative ? LONG_MIN : LONG_MAX;
+	value = value * 10 + digit;
+    }
+    return negative ? -value : value;
+}
+
+/* ************************************************************************* *
+ * Purpose: Convert a symbol type token to a symtype_t, as get_symtype_by_id *
+ *          does: only the first five characters are compared, in upper      *
+ *          case, so the token is not changed.                               *
+ * ************************************************************************* */
+static symtype_t token_symtype(const token_t* token)
+{
+    char code[6] = {0};
+    size_t i = 0;
+    for (i = 0; i < token->length && i < 5; i++)
+	code[i] = token->at[i];
+    return get_symtype_by_id(code);
+}
+
+/* ************************************************************************* *
+ * Purpose: Split a line into at most MAX_SYMLIST_TOKENS tokens              *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      int: how many tokens it has, counting no further than                *
+ *           MAX_SYMLIST_TOKENS since no line may have that many             *
+ * ************************************************************************* */
+static int split_line(const char* at,const char* end,token_t* tokens)
+{
+    int count = 0;
+    while (count < MAX_SYMLIST_TOKENS)
+    {
+	while (at < end && IS_SYMLIST_SPACE(*at))
+	    at++;
+	if (at == end)
+	    break;
+	tokens[count].at = at;
+	while (at < end && !IS_SYMLIST_SPACE(*at))
+	    at++;
+	tokens[count].length = at - tokens[count].at;
+	count++;
+    }
+    return count;
+}
+
+/* ************************************************************************* *
+ * Purpose: Hash the bytes of a label (32-bit FNV-1a)                        *
+ * ************************************************************************* */
+static uint32_t label_hash(const char* label,size_t length)
+{
+    uint32_t hash = 2166136261u;
+    size_t i = 0;
+    for (i = 0; i < length; i++)
+    {
+	hash ^= (unsigned char)label[i];
+	hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* ************************************************************************* *
+ * Purpose: Double the table that finds labels already in the pool           *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      int: 0 if success, 1 if out of memory                                *
+ * ************************************************************************* */
+static int slots_grow(symtab_t* symtab)
+{
+    uint32_t count = symtab->slot_count != 0 ? 2 * symtab->slot_count : 1024;
+    uint32_t* slots = calloc(count,sizeof(uint32_t));
+    uint32_t i = 0;
+    if (slots == NULL)
+	return 1;
+    for (i = 0; i < symtab->slot_count; i++)
+    {
+	if (symtab->slots[i] == 0)
+	    continue;
+	const char* label = symtab->strings + symtab->slots[i];
+	uint32_t slot = label_hash(label,strlen(label)) & (count - 1);
+	while (slots[slot] != 0)
+	    slot = (slot + 1) & (count - 1);
+	slots[slot] = symtab->slots[i];
+    }
+    free(symtab->slots);
+    symtab->slots = slots;
+    symtab->slot_count = count;
+    return 0;
+}
+
+/* ************************************************************************* *
+ * Purpose: Find a label in the string pool, adding it the first time        *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      symtab: the table                                                    *
+ *      label: the label's characters, not zero-terminated                   *
+ *      length: how many there are                                           *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      uint32_t: the label's offset in the pool, the same each time it is   *
+ *                added, or 0 if out of memory                               *
+ *                                                                           *
+ * Notes:                                                                    *
+ *      Labels already in the pool are found through an open-addressed       *
+ *      table of their offsets, kept no more than half full.                 *
+ * ************************************************************************* */
+static uint32_t intern_label(symtab_t* symtab,const char* label,size_t length)
+{
+    if (2 * (symtab->labels + 1) > symtab->slot_count && slots_grow(symtab))
+	return 0;
+
+    uint32_t slot = label_hash(label,length) & (symtab->slot_count - 1);
+    while (symtab->slots[slot] != 0)
+    {
+	const char* pooled = symtab->strings + symtab->slots[slot];
+	if (strncmp(pooled,label,length) == 0 && pooled[length] == '\0')
+	    return symtab->slots[slot];
+	slot = (slot + 1) & (symtab->slot_count - 1);
+    }
+
+    if (symtab->strings_length + length + 1 > symtab->strings_capacity)
+    {
+	size_t capacity = 2 * ((size_t)symtab->strings_length + length + 1);
+	char* strings = capacity <= UINT32_MAX ?
+	    realloc(symtab->strings,capacity) : NULL;
+	if (strings == NULL)
+	    return 0;
+	symtab->strings = strings;
+	symtab->strings_capacity = capacity;
+    }
+    uint32_t offset = symtab->strings_length;
+    memcpy(symtab->strings + offset,label,length);
+    symtab->strings[offset + length] = '\0';
+    symtab->strings_length += length + 1;
+    symtab->slots[slot] = offset;
+    symtab->labels++;
+    return offset;
+}
+
+/* ************************************************************************* *
+ * symtab_create -- makes an empty symbol table                              *
+ *                                                                           *
+ * Returns                                                                   *
+ *    the table (free it with symtab_free), or NULL if out of memory         *
+ * ************************************************************************* */
+symtab_t* symtab_create()
+{
+    symtab_t* symtab = calloc(1,sizeof(symtab_t));
+    if (symtab == NULL)
+	return NULL;
+    symtab->strings = malloc(256);
+    if (symtab->strings == NULL)
+    {
+	free(symtab);
+	return NULL;
+    }
+    symtab->strings[0] = '\0'; //the empty string no label is at
+    symtab->strings_length = 1;
+    symtab->strings_capacity = 256;
+    return symtab;
+}
+
+/* ************************************************************************* *
+ * symtab_add -- adds a symbol to the end of a table                         *
+ *                                                                           *
+ * Parameters                                                                *
+ *   symtab -- the table, not yet indexed                                    *
+ *   label -- the label's characters, not zero-terminated, or NULL for none  *
+ *   length -- how many there are                                            *
+ *   type -- a symtype_t                                                     *
+ *   offset -- the address the symbol names, from the start of the image     *
+ *   block_length -- the length of a BLOCK                                   *
+ *                                                                           *
+ * Returns                                                                   *
+ *    0 - if success                                                         *
+ *    1 - if out of memory                                                   *
+ *                                                                           *
+ * Notes                                                                     *
+ *    The array grows by doubling, so adding needs no allocation per         *
+ *    symbol, and a label that is already in the pool is not stored again.   *
+ * ************************************************************************* */
+int symtab_add(symtab_t* symtab,const char* label,size_t length,
+	       symtype_t type,uint16_t offset,uint16_t block_length)
+{
+    if (symtab->count == symtab->capacity)
+    {
+	uint32_t capacity = symtab->capacity != 0 ? 2 * symtab->capacity : 256;
+	symbol_t* symbols = realloc(symtab->symbols,
+				    capacity * sizeof(symbol_t));
+	if (symbols == NULL)
+	    return 1;
+	symtab->symbols = symbols;
+	symtab->capacity = capacity;
+    }
+
+    symbol_t* symbol = &symtab->symbols[symtab->count];
+    symbol->label = 0;
+    if (label != NULL && (symbol->label = intern_label(symtab,label,length))
+	== 0)
+	return 1;
+    symbol->type = type;
+    symbol->offset = offset;
+    symbol->block_length = type == BLOCK ? block_length : 0;
+    symtab->count++;
+    return 0;
+}
+
+/* ************************************************************************* *
+ * Purpose: Free a symbol table, its symbols and its labels                  *
+ * ************************************************************************* */
+void symtab_free(symtab_t* symtab)
+{
+    if (symtab == NULL)
+	return;
+    free(symtab->symbols);
+    free(symtab->strings);
+    free(symtab->slots);
+    free(symtab);
+}
+
+/* ************************************************************************* *
+ * Purpose: Read one line of a symlist                                       *
+ *                                                                           *
+ * Parameters:                                                               *
+ *      tokens: the line's tokens, from split_line                           *
+ *      count: how many there are, at least one                              *
+ *      type: receives the symbol type                                       *
+ *      offset: receives the offset                                          *
+ *      block_length: receives a BLOCK's length                              *
+ *                                                                           *
+ * Returns:                                                                  *
+ *      int: 0 if the line is a symbol, or the print_error_symtab code       *
+ *           saying what is wrong with it                                    *
+ * ************************************************************************* */
+static int read_symbol(token_t* tokens,int count,symtype_t* type,
+		       long* offset,long* block_length)
+{
+    //checking if there are at least 2 items on this line
+    if (count < 2)
+	return 3;
+    //does the symtype contain non-letters
+    if (!token_is(&tokens[1],isalpha))
+	return 1;
+    *type = token_symtype(&tokens[1]);
+    //is the symtype invalid
+    if (*type == INVALID_SYMTYPE_ID)
+	return 2;
+
+    //checking if there are at least 3 items on this line
+    if (count < 3)
+	return 3;
+    if (!token_is(&tokens[2],isdigit))
+	return 4;
+    *offset = token_value(&tokens[2]);
+
+    //protect against more than 3 items in a single line except for .BLOCK
+    *block_length = 0;
+    if (count > 3 && *type == BLOCK)
+	*block_length = token_value(&tokens[3]);
+    else if (count > 3)
+	return 5;
+    else if (*type == BLOCK)
+	return 6;
+    return 0;
+}
+
 /* ************************************************************************* *
  * symlist_open_and_read -- opens and reads the symlist into an array        *
  *                                                                           *
  * Parameters                                                                *
  *   filename -- the name of the file to open to read                        *
- *   array -- An array of char* passed by reference                          *
- *   file_length -- the number of elements in the file                       *
+ *   symtab -- receives the symbol table, in file order, or NULL if the      *
+ *             file has no symbols                                           *
+ *   symbols -- receives the same symbols indexed by address (see            *
+ *              symtab_index_build), for every lookup after this one         *
  *                                                                           *
  * Returns                                                                   *
  *    0 - if success                                                         *
  *    1 - if failure                                                         *
+ *                                                                           *
+ * Notes                                                                     *
+ *    Each line is a label, a symbol type, an offset and, for a BLOCK, a     *
+ *    length, separated by spaces or tabs; blank lines are skipped.  The     *
+ *    file is mapped and read in one pass with no allocation per line, and   *
+ *    lines may be any length.  A symbol whose offset is past the 64 KB      *
+ *    address space can never name an address and is left out; a BLOCK       *
+ *    length is kept to 16 bits, as the disassembler has always used it.     *
  * ************************************************************************* */
-int symlist_open_and_read(const char* filename,symtab_t** symtab)
+int symlist_open_and_read(const char* filename,symtab_t** symtab,
+			  symtab_index_t** symbols)
 {
-    FILE *fp = fopen (filename, "r");
-    if (fp == NULL)
+    struct stat st;
+    int fd = open(filename,O_RDONLY);
+    if (fd < 0)
     {
         printf("File \"%s\" does not exist\n",filename);
         return 1;
     }
-    /* check if file is empty
-    if (fseek(fp, 0, SEEK_END) != 0)
+    if (fstat(fd,&st) != 0 || !S_ISREG(st.st_mode)) /* a file we can map */
     {
         printf("Error with File\n");
+        close(fd);
         return 1;
     }
-    if (ftell(fp) == 0)
+    const char* contents = st.st_size > 0 ?
+	mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0) : NULL;
+    close(fd);
+    if (contents == MAP_FAILED)
     {
-        printf("Error File Empty\n");
+        printf("Error with File\n");
         return 1;
     }
-    fseek(fp,0,SEEK_SET);
-    */
-
-    // fill linked list of symtabs for symbol table
-    char buffer[50];
-    char* token;
-    const char delim[]=" \n\r\t";
-    *symtab = malloc(sizeof(symtab_t));
-    symtab_t *cur_symtab = *symtab; //current symtab
-
-    while (fgets (buffer, 50, fp) != NULL)
-    {
-        token = strtok(buffer,delim);
-        //checking if there is at least one item on this line
-        if (token != NULL)
-            cur_symtab->label = strdup(token);
-        else //file contains an empty line, moving on to next line
-            continue;
-        token = strtok(NULL,delim);
-        //checking if there are at least 2 items on this line
-        if (token != NULL)
-        {
-            //does the symtype contain non-letters
-            if (letters_only(token) == 1)
-                return print_error_symtab(filename,1);
-            cur_symtab->type = get_symtype_by_id(token);
-            
-	    //is the symtype invalid
-            if (cur_symtab->type == INVALID_SYMTYPE_ID)
-                return print_error_symtab(filename,2);
-        }
-        else
-            return print_error_symtab(filename,3);
-        token = strtok(NULL,delim);
-        //checking if there are at least 3 items on this line
-        if (token != NULL)
-        {
-            if (numbers_only(token))
-                return print_error_symtab(filename,4);
-            char* ptr; //used for below line and subsequently scrapped
-            long int temp = strtol(token,&ptr,10);
-            cur_symtab->offset = (off_t)temp;
-        }
-        else
-            return print_error_symtab(filename,3);
-        token = strtok(NULL,delim);
-        
-	//protect against more than 3 items in a single line except for .BLOCK
-	if (token != NULL && cur_symtab->type == BLOCK)
-            cur_symtab->block_length = (size_t)atoi(token);
-        else if (token != NULL)
-            return print_error_symtab(filename,5);
-	else if (token == NULL && cur_symtab->type == BLOCK)
-	    return print_error_symtab(filename,6);
-	if (!feof(fp)) //returns nonzero if end-of-file has been reached on fp
-        {
-            cur_symtab->next = malloc(sizeof(symtab_t));
-            cur_symtab = cur_symtab->next;
-        }
+
+    symtab_t* table = symtab_create();
+    int error = 0;
+    unsigned line = 0;
+    const char* at = contents;
+    const char* end = contents + st.st_size;
+    while (at < end && table != NULL && error == 0)
+    {
+	token_t tokens[MAX_SYMLIST_TOKENS];
+	symtype_t type;
+	long offset = 0;
+	long block_length = 0;
+	const char* eol = memchr(at,'\n',end - at);
+	if (eol == NULL)
+	    eol = end;
+	int found = split_line(at,eol,tokens);
+	at = eol + 1;
+	line++;
+	if (found == 0) //file contains an empty line, moving on to next line
+	    continue;
+
+	error = read_symbol(tokens,found,&type,&offset,&block_length);
+	if (error == 0 && offset < SYMTAB_INDEX_SIZE &&
+	    symtab_add(table,tokens[0].at,tokens[0].length,type,offset,
+		       block_length))
+	    break;
     }
-    cur_symtab->next = NULL; //set the final symtab next to NULL
+    if (contents != NULL)
+	munmap((void*)contents,st.st_size);
 
-    //workaround to fix the fact that you end up with extra symtab
-    //checks if cur_symtab->next->next == NULL
-    //Then sets cur_symtab->next == NULL to get rid of empty symtab
-    cur_symtab = *symtab;
-    while (cur_symtab->next->next != NULL)
-	cur_symtab = cur_symtab->next;
-    cur_symtab->next = NULL;
+    if (error != 0 || at < end || table == NULL)
+    {
+	symtab_free(table);
+	if (error != 0)
+	    return print_error_symtab(filename,error,line);
+	printf("Error No memory allocated");
+	return 1;
+    }
+    if (table->count == 0)
+    {
+	symtab_free(table);
+	table = NULL;
+    }
+    *symtab = table;
 
-    fclose(fp);
+    //index the symbols by address once, for everything that looks them up
+    *symbols = symtab_index_build(*symtab);
+    if (*symbols == NULL)
+    {
+	printf("Error No memory allocated");
+	return 1;
+    }
     return 0;
 }
 
+
+/* ************************************************************************* *
+ * symtab_index_build -- indexes the symbol table by address                 *
+ *                                                                           *
+ * Parameters                                                                *
+ *   symtab -- the table, NULL for an index with no symbols                  *
+ *                                                                           *
+ * Returns                                                                   *
+ *    the index (free it with symtab_index_free), or NULL if out of memory   *
+ *                                                                           *
+ * Notes                                                                     *
+ *    Where two symbols share an offset the first one in the list wins, as   *
+ *    it did when the list was searched.  The index points into the table,   *
+ *    so nothing is added to it after this: the array and the pool are cut   *
+ *    down to what they hold and the label lookup is dropped.                *
+ * ************************************************************************* */
+symtab_index_t* symtab_index_build(symtab_t* symtab)
+{
+    symtab_index_t* symbols = calloc(1,sizeof(symtab_index_t));
+    uint32_t i = 0;
+    if (symbols == NULL)
+	return NULL;
+    symbols->symtab = symtab;
+    if (symtab == NULL)
+	return symbols;
+
+    if (symtab->count > 0 && symtab->count < symtab->capacity)
+    {
+	symbol_t* trimmed = realloc(symtab->symbols,
+				    symtab->count * sizeof(symbol_t));
+	if (trimmed != NULL)
+	{
+	    symtab->symbols = trimmed;
+	    symtab->capacity = symtab->count;
+	}
+    }
+    if (symtab->slots != NULL)
+    {
+	char* trimmed = realloc(symtab->strings,symtab->strings_length);
+	if (trimmed != NULL)
+	{
+	    symtab->strings = trimmed;
+	    symtab->strings_capacity = symtab->strings_length;
+	}
+	free(symtab->slots);
+	symtab->slots = NULL;
+	symtab->slot_count = 0;
+    }
+
+    for (i = 0; i < symtab->count; i++)
+    {
+	symbol_t* symbol = &symtab->symbols[i];
+	if (symbols->at[symbol->offset] == NULL)
+	    symbols->at[symbol->offset] = symbol;
+    }
+    return symbols;
+}
+
+/* ************************************************************************* *
+ * Purpose: Free an index from symtab_index_build.  The symbols stay.        *
+ * ************************************************************************* */
+void symtab_index_free(symtab_index_t* symbols)
+{
+    free(symbols);
+}
@@ -5,11 +5,16 @@
 extern const char *SYMTYPES[];
 
 /* Prototypes */
-int symlist_open_and_read(const char *,symtab_t**);
-int print_error_symtab(const char *,uint8_t);
+int symlist_open_and_read(const char *,symtab_t**,symtab_index_t**);
+int print_error_symtab(const char *,uint8_t,unsigned);
 symtype_t get_symtype_by_id(char *);
 int letters_only(char *);
 int numbers_only(char *);
 void toUpperCase(char *);
+symtab_t* symtab_create();
+int symtab_add(symtab_t*,const char*,size_t,symtype_t,uint16_t,uint16_t);
+void symtab_free(symtab_t*);
+symtab_index_t* symtab_index_build(symtab_t*);
+void symtab_index_free(symtab_index_t*);
 
 #endif
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+------------------------------------
+Status bits (NZVC)          0 1 0 1 
+Accumulator (A)             0x0FFB
+Index Register (X)          0x0000
+Program counter (PC)        0x0019
+Instruction register (IR)   0x000000
+------------------------------------
+EOF
+pass;
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+
+--------------------------------------
+Addr  Code   Symbol  Mnemonic  Operand
+--------------------------------------
+0000  C00063         LDA       0x0063,i
+0003  E10001         STA       0x0001,d
+0006  510001         CHARO     0x0001,d
+
+
+EOF
+pass;
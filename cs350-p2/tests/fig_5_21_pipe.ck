@@ -0,0 +1,30 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+
+--------------------------------------
+Addr  Code   Symbol  Mnemonic  Operand
+--------------------------------------
+0000  040006         BR        0x0006,i
+0003  00             STOP      
+0004  00             STOP      
+0005  00             STOP      
+0006  490003         CHARI     0x0003,d
+0009  310004         DECI      0x0004,d
+000C  C10004         LDA       0x0004,d
+000F  700005         ADDA      0x0005,i
+0012  E10004         STA       0x0004,d
+0015  D10003         LDBYTEA   0x0003,d
+0018  700001         ADDA      0x0001,i
+001B  F10003         STBYTEA   0x0003,d
+001E  510003         CHARO     0x0003,d
+0021  50000A         CHARO     0x000A,i
+0024  390004         DECO      0x0004,d
+0027  50000A         CHARO     0x000A,i
+002A  00             STOP      
+
+
+EOF
+pass;
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+# -t reports the cache on stderr; the times vary from run to run.
+my (@errors) = grep (!/^Time saved/, read_text_file ("$test.errors"));
+compare_output ("run", \@errors, [<<'EOF']);
+Disassembly cache           hit
+Cache hits, all runs        1
+Cache misses, all runs      1
+Cache hit rate              50.0%
+EOF
+pass;
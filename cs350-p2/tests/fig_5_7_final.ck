@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+------------------------------------
+Status bits (NZVC)          0 0 0 0 
+Accumulator (A)             0x0038
+Index Register (X)          0x0000
+Program counter (PC)        0x0010
+Instruction register (IR)   0x003800
+------------------------------------
+EOF
+pass;
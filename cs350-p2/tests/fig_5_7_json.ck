@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+{"addr":0,"bytes":"C10011","label":null,"mnemonic":"LDA","operand":17,"operand_label":"word1","mode":"d","symtype":null}
+{"addr":3,"bytes":"710013","label":null,"mnemonic":"ADDA","operand":19,"operand_label":"word2","mode":"d","symtype":null}
+{"addr":6,"bytes":"A10015","label":null,"mnemonic":"ORA","operand":21,"operand_label":"word3","mode":"d","symtype":null}
+{"addr":9,"bytes":"F10010","label":null,"mnemonic":"STBYTEA","operand":16,"operand_label":"thing","mode":"d","symtype":null}
+{"addr":12,"bytes":"510010","label":null,"mnemonic":"CHARO","operand":16,"operand_label":"thing","mode":"d","symtype":null}
+{"addr":15,"bytes":"00","label":null,"mnemonic":"STOP","operand":null,"operand_label":null,"mode":null,"symtype":null}
+{"addr":16,"bytes":"00","label":"thing","mnemonic":".BLOCK","operand":1,"operand_label":null,"mode":null,"symtype":"BLOCK"}
+{"addr":17,"bytes":"0005","label":"word1","mnemonic":".WORD","operand":5,"operand_label":null,"mode":null,"symtype":"WORD"}
+{"addr":19,"bytes":"0003","label":"word2","mnemonic":".WORD","operand":3,"operand_label":null,"mode":null,"symtype":"WORD"}
+{"addr":21,"bytes":"0030","label":"word3","mnemonic":".WORD","operand":48,"operand_label":null,"mode":null,"symtype":"WORD"}
+EOF
+pass;
@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+References to thing (0x0010): 1 read, 1 write
+0009  F10010         STBYTEA   thing,d
+000C  510010         CHARO     thing,d
+EOF
+pass;
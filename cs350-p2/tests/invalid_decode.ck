@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+------------------------------------
+Status bits (NZVC)          0 0 0 0 
+Accumulator (A)             0x0000
+Index Register (X)          0x0000
+Program counter (PC)        0x0003
+Instruction register (IR)   0x490000
+The given instruction "CHARI" is not supported by this interpreter.  Exiting program 
+EOF
+pass;
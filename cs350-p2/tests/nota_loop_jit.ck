@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+------------------------------------
+Status bits (NZVC)          0 1 0 1 
+Accumulator (A)             0xFFFE
+Index Register (X)          0x7FFF
+Program counter (PC)        0x000E
+Instruction register (IR)   0x000000
+------------------------------------
+EOF
+pass;
@@ -0,0 +1,88 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+------------------------------------
+Status bits (NZVC)          0 0 0 0 
+Accumulator (A)             0x0000
+Index Register (X)          0x0000
+Program counter (PC)        0x0003
+Instruction register (IR)   0xC80002
+------------------------------------
+Status bits (NZVC)          0 0 0 0 
+Accumulator (A)             0x0000
+Index Register (X)          0x0002
+Program counter (PC)        0x0006
+Instruction register (IR)   0x500041
+------------------------------------
+  Output 'A'
+------------------------------------
+Status bits (NZVC)          0 0 0 0 
+Accumulator (A)             0x0000
+Index Register (X)          0x0002
+Program counter (PC)        0x0009
+Instruction register (IR)   0xC0005A
+------------------------------------
+Status bits (NZVC)          0 0 0 0 
+Accumulator (A)             0x005A
+Index Register (X)          0x0002
+Program counter (PC)        0x000C
+Instruction register (IR)   0xF10005
+------------------------------------
+  Mem[0005] <-- 0x005A
+------------------------------------
+Status bits (NZVC)          0 0 0 0 
+Accumulator (A)             0x005A
+Index Register (X)          0x0002
+Program counter (PC)        0x000F
+Instruction register (IR)   0x880001
+------------------------------------
+Status bits (NZVC)          0 0 0 1 
+Accumulator (A)             0x005A
+Index Register (X)          0x0001
+Program counter (PC)        0x0012
+Instruction register (IR)   0x0C0003
+------------------------------------
+Status bits (NZVC)          0 0 0 1 
+Accumulator (A)             0x005A
+Index Register (X)          0x0001
+Program counter (PC)        0x0006
+Instruction register (IR)   0x50005A
+------------------------------------
+  Output 'Z'
+------------------------------------
+Status bits (NZVC)          0 0 0 1 
+Accumulator (A)             0x005A
+Index Register (X)          0x0001
+Program counter (PC)        0x0009
+Instruction register (IR)   0xC0005A
+------------------------------------
+Status bits (NZVC)          0 0 0 1 
+Accumulator (A)             0x005A
+Index Register (X)          0x0001
+Program counter (PC)        0x000C
+Instruction register (IR)   0xF10005
+------------------------------------
+  Mem[0005] <-- 0x005A
+------------------------------------
+Status bits (NZVC)          0 0 0 1 
+Accumulator (A)             0x005A
+Index Register (X)          0x0001
+Program counter (PC)        0x000F
+Instruction register (IR)   0x880001
+------------------------------------
+Status bits (NZVC)          0 1 0 1 
+Accumulator (A)             0x005A
+Index Register (X)          0x0000
+Program counter (PC)        0x0012
+Instruction register (IR)   0x0C0003
+------------------------------------
+Status bits (NZVC)          0 1 0 1 
+Accumulator (A)             0x005A
+Index Register (X)          0x0000
+Program counter (PC)        0x0013
+Instruction register (IR)   0x000000
+------------------------------------
+EOF
+pass;
@@ -0,0 +1,101 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+
+--------------------------------------
+Addr  Code   Symbol  Mnemonic  Operand
+--------------------------------------
+0000  C80002         LDX       0x0002,i
+0003  500041         CHARO     0x0041,i
+0006  C0005A         LDA       0x005A,i
+0009  F10005         STBYTEA   0x0005,d
+000C  880001         SUBX      0x0001,i
+000F  0C0003         BRNE      0x0003,i
+0012  00             STOP      
+
+
+------------------------------------
+Status bits (NZVC)          0 0 0 0 
+Accumulator (A)             0x0000
+Index Register (X)          0x0000
+Program counter (PC)        0x0003
+Instruction register (IR)   0xC80002
+------------------------------------
+Status bits (NZVC)          0 0 0 0 
+Accumulator (A)             0x0000
+Index Register (X)          0x0002
+Program counter (PC)        0x0006
+Instruction register (IR)   0x500041
+------------------------------------
+  Output 'A'
+------------------------------------
+Status bits (NZVC)          0 0 0 0 
+Accumulator (A)             0x0000
+Index Register (X)          0x0002
+Program counter (PC)        0x0009
+Instruction register (IR)   0xC0005A
+------------------------------------
+Status bits (NZVC)          0 0 0 0 
+Accumulator (A)             0x005A
+Index Register (X)          0x0002
+Program counter (PC)        0x000C
+Instruction register (IR)   0xF10005
+------------------------------------
+  Mem[0005] <-- 0x005A
+------------------------------------
+Status bits (NZVC)          0 0 0 0 
+Accumulator (A)             0x005A
+Index Register (X)          0x0002
+Program counter (PC)        0x000F
+Instruction register (IR)   0x880001
+------------------------------------
+Status bits (NZVC)          0 0 0 1 
+Accumulator (A)             0x005A
+Index Register (X)          0x0001
+Program counter (PC)        0x0012
+Instruction register (IR)   0x0C0003
+------------------------------------
+Status bits (NZVC)          0 0 0 1 
+Accumulator (A)             0x005A
+Index Register (X)          0x0001
+Program counter (PC)        0x0006
+Instruction register (IR)   0x50005A
+------------------------------------
+  Output 'Z'
+------------------------------------
+Status bits (NZVC)          0 0 0 1 
+Accumulator (A)             0x005A
+Index Register (X)          0x0001
+Program counter (PC)        0x0009
+Instruction register (IR)   0xC0005A
+------------------------------------
+Status bits (NZVC)          0 0 0 1 
+Accumulator (A)             0x005A
+Index Register (X)          0x0001
+Program counter (PC)        0x000C
+Instruction register (IR)   0xF10005
+------------------------------------
+  Mem[0005] <-- 0x005A
+------------------------------------
+Status bits (NZVC)          0 0 0 1 
+Accumulator (A)             0x005A
+Index Register (X)          0x0001
+Program counter (PC)        0x000F
+Instruction register (IR)   0x880001
+------------------------------------
+Status bits (NZVC)          0 1 0 1 
+Accumulator (A)             0x005A
+Index Register (X)          0x0000
+Program counter (PC)        0x0012
+Instruction register (IR)   0x0C0003
+------------------------------------
+Status bits (NZVC)          0 1 0 1 
+Accumulator (A)             0x005A
+Index Register (X)          0x0000
+Program counter (PC)        0x0013
+Instruction register (IR)   0x000000
+------------------------------------
+EOF
+pass;
@@ -3,6 +3,7 @@ use strict;
 use warnings;
 use tests::tests;
 check_expected ([<<'EOF']);
-Symbol file "../symlist_fail3.txt" is illegally formatted
+Symbol file "../symlist_fail3.txt" is illegally formatted on line 1
+Each line of symbol table must contain at least 3 items
 EOF
 pass;
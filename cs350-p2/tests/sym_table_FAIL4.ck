@@ -3,6 +3,7 @@ use strict;
 use warnings;
 use tests::tests;
 check_expected ([<<'EOF']);
-Filename is a required argument
+Symbol file "../symlist_fail4.txt" is illegally formatted on line 1
+The byte for one of the symbols is invalid
 EOF
 pass;
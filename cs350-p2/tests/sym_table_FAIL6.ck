@@ -3,6 +3,7 @@ use strict;
 use warnings;
 use tests::tests;
 check_expected ([<<'EOF']);
-Filename is a required argument
+Symbol file "../symlist_fail6.txt" is illegally formatted on line 1
+Each line of symbol table (excluding block symbols) can not exceed 3 items
 EOF
 pass;
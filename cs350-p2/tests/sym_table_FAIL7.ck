@@ -3,6 +3,7 @@ use strict;
 use warnings;
 use tests::tests;
 check_expected ([<<'EOF']);
-Filename is a required argument
+Symbol file "../symlist_fail7.txt" is illegally formatted on line 1
+Your symbol type contained characters that were not letters
 EOF
 pass;
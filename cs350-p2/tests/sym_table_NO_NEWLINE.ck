@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+{"addr":0,"bytes":"040003","label":null,"mnemonic":"BR","operand":3,"operand_label":"main","mode":"i","symtype":null}
+{"addr":3,"bytes":"680002","label":"main","mnemonic":"SUBSP","operand":2,"operand_label":null,"mode":"i","symtype":"LINE"}
+{"addr":6,"bytes":"330000","label":null,"mnemonic":"DECI","operand":0,"operand_label":null,"mode":"s","symtype":null}
+{"addr":9,"bytes":"C30000","label":"if","mnemonic":"LDA","operand":0,"operand_label":null,"mode":"s","symtype":"LINE"}
+{"addr":12,"bytes":"B00064","label":null,"mnemonic":"CPA","operand":100,"operand_label":null,"mode":"i","symtype":null}
+{"addr":15,"bytes":"080018","label":null,"mnemonic":"BRLT","operand":24,"operand_label":"else","mode":"i","symtype":null}
+{"addr":18,"bytes":"41001F","label":null,"mnemonic":"STRO","operand":31,"operand_label":"msg1","mode":"d","symtype":null}
+{"addr":21,"bytes":"04001B","label":null,"mnemonic":"BR","operand":27,"operand_label":"endIf","mode":"i","symtype":null}
+{"addr":24,"bytes":"410024","label":"else","mnemonic":"STRO","operand":36,"operand_label":"msg2","mode":"d","symtype":"LINE"}
+{"addr":27,"bytes":"600002","label":"endIf","mnemonic":"ADDSP","operand":2,"operand_label":null,"mode":"i","symtype":"LINE"}
+{"addr":30,"bytes":"00","label":null,"mnemonic":"STOP","operand":null,"operand_label":null,"mode":null,"symtype":null}
+{"addr":31,"bytes":"6869676800","label":"msg1","mnemonic":".ASCII","operand":"high","operand_label":null,"mode":null,"symtype":"ASCII"}
+{"addr":36,"bytes":"6C6F7700","label":"msg2","mnemonic":".ASCII","operand":"low","operand_label":null,"mode":null,"symtype":"ASCII"}
+EOF
+pass;
@@ -3,6 +3,22 @@ use strict;
 use warnings;
 use tests::tests;
 check_expected ([<<'EOF']);
-Filename is a required argument
+{"addr":0,"bytes":"040006","label":null,"mnemonic":"BR","operand":6,"operand_label":null,"mode":"i","symtype":null}
+{"addr":3,"bytes":"00","label":null,"mnemonic":"STOP","operand":null,"operand_label":null,"mode":null,"symtype":null}
+{"addr":4,"bytes":"00","label":null,"mnemonic":"STOP","operand":null,"operand_label":null,"mode":null,"symtype":null}
+{"addr":5,"bytes":"00","label":"msg","mnemonic":".ASCII","operand":"","operand_label":null,"mode":null,"symtype":"ASCII"}
+{"addr":6,"bytes":"490003","label":null,"mnemonic":"CHARI","operand":3,"operand_label":null,"mode":"d","symtype":null}
+{"addr":9,"bytes":"310004","label":null,"mnemonic":"DECI","operand":4,"operand_label":null,"mode":"d","symtype":null}
+{"addr":12,"bytes":"C10004","label":null,"mnemonic":"LDA","operand":4,"operand_label":null,"mode":"d","symtype":null}
+{"addr":15,"bytes":"700005","label":null,"mnemonic":"ADDA","operand":5,"operand_label":"msg","mode":"i","symtype":null}
+{"addr":18,"bytes":"E10004","label":null,"mnemonic":"STA","operand":4,"operand_label":null,"mode":"d","symtype":null}
+{"addr":21,"bytes":"D10003","label":null,"mnemonic":"LDBYTEA","operand":3,"operand_label":null,"mode":"d","symtype":null}
+{"addr":24,"bytes":"700001","label":null,"mnemonic":"ADDA","operand":1,"operand_label":null,"mode":"i","symtype":null}
+{"addr":27,"bytes":"F10003","label":null,"mnemonic":"STBYTEA","operand":3,"operand_label":null,"mode":"d","symtype":null}
+{"addr":30,"bytes":"510003","label":null,"mnemonic":"CHARO","operand":3,"operand_label":null,"mode":"d","symtype":null}
+{"addr":33,"bytes":"50000A","label":null,"mnemonic":"CHARO","operand":10,"operand_label":null,"mode":"i","symtype":null}
+{"addr":36,"bytes":"390004","label":null,"mnemonic":"DECO","operand":4,"operand_label":null,"mode":"d","symtype":null}
+{"addr":39,"bytes":"50000A","label":null,"mnemonic":"CHARO","operand":10,"operand_label":null,"mode":"i","symtype":null}
+{"addr":42,"bytes":"00","label":null,"mnemonic":"STOP","operand":null,"operand_label":null,"mode":null,"symtype":null}
 EOF
 pass;
@@ -3,6 +3,19 @@ use strict;
 use warnings;
 use tests::tests;
 check_expected ([<<'EOF']);
-Filename is a required argument
+{"addr":0,"bytes":"040003","label":null,"mnemonic":"BR","operand":3,"operand_label":null,"mode":"i","symtype":null}
+{"addr":3,"bytes":"680002","label":null,"mnemonic":"SUBSP","operand":2,"operand_label":null,"mode":"i","symtype":null}
+{"addr":6,"bytes":"330000","label":null,"mnemonic":"DECI","operand":0,"operand_label":null,"mode":"s","symtype":null}
+{"addr":9,"bytes":"C30000","label":null,"mnemonic":"LDA","operand":0,"operand_label":null,"mode":"s","symtype":null}
+{"addr":12,"bytes":"B00064","label":null,"mnemonic":"CPA","operand":100,"operand_label":null,"mode":"i","symtype":null}
+{"addr":15,"bytes":"080018","label":null,"mnemonic":"BRLT","operand":24,"operand_label":null,"mode":"i","symtype":null}
+{"addr":18,"bytes":"41001F","label":null,"mnemonic":"STRO","operand":31,"operand_label":null,"mode":"d","symtype":null}
+{"addr":21,"bytes":"04001B","label":null,"mnemonic":"BR","operand":27,"operand_label":null,"mode":"i","symtype":null}
+{"addr":24,"bytes":"410024","label":null,"mnemonic":"STRO","operand":36,"operand_label":null,"mode":"d","symtype":null}
+{"addr":27,"bytes":"600002","label":null,"mnemonic":"ADDSP","operand":2,"operand_label":null,"mode":"i","symtype":null}
+{"addr":30,"bytes":"00","label":null,"mnemonic":"STOP","operand":null,"operand_label":null,"mode":null,"symtype":null}
+{"addr":31,"bytes":"686967","label":null,"mnemonic":"SUBSP","operand":26983,"operand_label":null,"mode":"i","symtype":null}
+{"addr":34,"bytes":"68006C","label":null,"mnemonic":"SUBSP","operand":108,"operand_label":null,"mode":"i","symtype":null}
+{"addr":37,"bytes":"6F7700","label":null,"mnemonic":"SUBSP","operand":30464,"operand_label":null,"mode":"sxf","symtype":null}
 EOF
 pass;
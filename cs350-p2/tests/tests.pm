@@ -82,7 +82,9 @@ sub compare_output {
 	    $expected = {map ((++$i => $_), @$expected)};
     }
     foreach my $key (keys %$expected) {
-	    my (@expected) = split ("\n", $expected->{$key});
+	    # Keep trailing blank lines; drop only the heredoc's final newline.
+	    my (@expected) = split ("\n", $expected->{$key}, -1);
+	    pop (@expected) if @expected && $expected[$#expected] eq '';
 
 	    $msg .= "Acceptable output:\n";
 	    $msg .= join ('', map ("  $_\n", @expected));